@@ -0,0 +1,643 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+    Created: 17 Oct 2026 5:02:27am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+//smodels-bench: times the analysis/resynthesis hot paths on synthetic input and writes the results as JSON.
+//given a baseline (an earlier run's JSON) it also reports anything that got slower and exits nonzero
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Noise.h"
+#include "OscillatorBank.h"
+#include "SinusoidalModel.h"
+
+#define BENCHSAMPLERATE 44100
+#define BENCHSIGNALLENGTH (BENCHSAMPLERATE * 8)
+#define BENCHBLOCKSIZE 512 //what processBlock typically gets handed
+#define BENCHCHORDSIZE 48
+
+typedef std::chrono::steady_clock Clock;
+
+struct Signal{
+    std::string name;
+    std::vector<float> data;
+};
+
+struct Config{
+    int windowSize, hopFactor, resolutions;
+    bool padded;
+};
+
+struct Result{
+    std::string name, stage, signal;
+    int windowSize, hopFactor, count;
+    bool padded;
+    double median, min, perSample;//ns per call, ns per call, ns per input sample (per oscillator for the oscillator stages)
+};
+
+struct Settings{
+    std::vector<int> windowSizes, hopFactors, oscillatorCounts, resolutions;
+    std::vector<bool> paddings;
+    std::vector<std::string> signals;
+    std::string outputPath, baselinePath;
+    Analysis::PRECISION precision;
+    Analysis::ESTIMATOR estimator;
+    int hops;
+    double tolerance;
+};
+
+//////////////////////////////////////////////////////////////
+//  Test signals
+//////////////////////////////////////////////////////////////
+//everything is seeded, so every run (and every machine) analyzes exactly the same input
+static Signal makeSweep(){//exponential sine sweep, 20 Hz to 20 kHz
+    Signal s;
+    double f0 = 20.0, f1 = 20000.0, duration = (double)BENCHSIGNALLENGTH / BENCHSAMPLERATE, k = log(f1 / f0), t;
+    s.name = "sweep";
+    s.data.resize(BENCHSIGNALLENGTH);
+    for(int i = 0; i < BENCHSIGNALLENGTH; ++i){
+        t = (double)i / BENCHSAMPLERATE;
+        s.data[i] = (float)(0.5 * sin(2.0 * M_PI * f0 * duration / k * (exp(t * k / duration) - 1.0)));
+    }
+    return s;
+}
+
+static Signal makeChord(){//stiff string partials, so they're dense and drift off the harmonic series
+    Signal s;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> phase(0.0, 2.0 * M_PI);
+    double frq[BENCHCHORDSIZE], amp[BENCHCHORDSIZE], phs[BENCHCHORDSIZE], f0 = 87.31, inharmonicity = 4e-4, sum = 0.0, x;
+    int j, k;
+    s.name = "chord";
+    s.data.resize(BENCHSIGNALLENGTH);
+    for(j = 0; j < BENCHCHORDSIZE; ++j){
+        k = j + 1;
+        frq[j] = k * f0 * sqrt(1.0 + inharmonicity * k * k);
+        amp[j] = 1.0 / k;
+        phs[j] = phase(rng);
+        sum += amp[j];
+    }
+    for(int i = 0; i < BENCHSIGNALLENGTH; ++i){
+        x = 0.0;
+        for(j = 0; j < BENCHCHORDSIZE; ++j){
+            x += amp[j] * sin(2.0 * M_PI * frq[j] * i / BENCHSAMPLERATE + phs[j]);
+        }
+        s.data[i] = (float)(0.9 * x / sum);
+    }
+    return s;
+}
+
+static Signal makeNoise(){//white, the worst case for track birth and death
+    Signal s;
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    s.name = "noise";
+    s.data.resize(BENCHSIGNALLENGTH);
+    for(int i = 0; i < BENCHSIGNALLENGTH; ++i){
+        s.data[i] = dist(rng);
+    }
+    return s;
+}
+
+//////////////////////////////////////////////////////////////
+//  Timing helpers
+//////////////////////////////////////////////////////////////
+static double elapsed(const Clock::time_point &start){
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static std::string configName(const Config &c){
+    std::ostringstream name;
+    name << "w" << c.windowSize << "/f" << c.hopFactor << "/" << (c.padded?"padded":"unpadded");
+    if(c.resolutions > 1){//single resolution names are as they always were, so old baselines still match
+        name << "/r" << c.resolutions;
+    }
+    return name.str();
+}
+
+static Result summarize(const std::string &stage, const std::string &signal, const Config &c, std::vector<double> &times, const double samples){
+    Result r;
+    std::sort(times.begin(), times.end());
+    r.stage = stage;
+    r.signal = signal;
+    r.name = stage + "/" + signal + "/" + configName(c);
+    r.windowSize = c.windowSize;
+    r.hopFactor = c.hopFactor;
+    r.padded = c.padded;
+    r.count = (int)times.size();
+    r.median = times[times.size() / 2];
+    r.min = times[0];
+    r.perSample = r.median / samples;
+    return r;
+}
+
+//feed the analysis until it has a frame ready, wrapping around the signal
+static void feed(Analysis &analysis, const Signal &s, int &pos){
+    int n;
+    bool ready = false;
+    while(!ready){
+        n = std::min(analysis.getSamplesUntilFFT(), (int)s.data.size() - pos);
+        ready = analysis.write(&s.data[pos], n);
+        pos = (pos + n) % (int)s.data.size();
+    }
+}
+
+static void feed(SinusoidalModel &model, const Signal &s, int &pos){
+    bool ready = false;
+    while(!ready){
+        ready = model(s.data[pos]);
+        pos = (pos + 1) % (int)s.data.size();
+    }
+}
+
+//////////////////////////////////////////////////////////////
+//  Benchmarks
+//////////////////////////////////////////////////////////////
+//Analysis::transform(FFT), then each spectrum the model or display can ask for, one at a time
+static void benchAnalysis(const Signal &s, const Config &c, const Settings &settings, std::vector<Result> &results){
+    Analysis analysis(Analysis::WINDOW::GAUSSIAN, c.windowSize, c.hopFactor, BENCHSAMPLERATE, c.padded);
+    std::vector<double> fft, amp, mag, phs;
+    Clock::time_point start;
+    int h, pos = 0, hopSize = c.windowSize / c.hopFactor;
+    analysis.setPrecision(settings.precision);
+    analysis.setEstimator(settings.estimator);
+    analysis.init();
+    for(h = -c.hopFactor; h < settings.hops; ++h){//first few hops fill the window
+        feed(analysis, s, pos);
+        start = Clock::now();
+        analysis.transform(Analysis::TRANSFORM::FFT);
+        if(h >= 0){
+            fft.push_back(elapsed(start));
+        }
+        start = Clock::now();
+        analysis.update(Analysis::PARAMETER::AMP);
+        if(h >= 0){
+            amp.push_back(elapsed(start));
+        }
+        start = Clock::now();
+        analysis.update(Analysis::PARAMETER::MAG);
+        if(h >= 0){
+            mag.push_back(elapsed(start));
+        }
+        start = Clock::now();
+        analysis.update(Analysis::PARAMETER::PHS);
+        if(h >= 0){
+            phs.push_back(elapsed(start));
+        }
+    }
+    results.push_back(summarize("transform", s.name, c, fft, hopSize));
+    results.push_back(summarize("spectrum.amp", s.name, c, amp, hopSize));
+    results.push_back(summarize("spectrum.mag", s.name, c, mag, hopSize));
+    results.push_back(summarize("spectrum.phs", s.name, c, phs, hopSize));
+}
+
+//the breakpoint() stages, timed separately. magnitudes are derived beforehand so detect doesn't pay for them
+static void benchBreakpoint(const Signal &s, const Config &c, const Settings &settings, std::vector<Result> &results){
+    SinusoidalModel model(Analysis::WINDOW::GAUSSIAN, c.windowSize, c.hopFactor, BENCHSAMPLERATE, c.padded, Wavetable<float>::WAVEFORM::SINE, 2048);
+    std::vector<double> detect, match, birth, update, total;
+    double t[4];
+    Clock::time_point start;
+    int h, pos = 0, hopSize = c.windowSize / c.hopFactor;
+    model.setPrecision(settings.precision);
+    model.setEstimator(settings.estimator);
+    model.init();
+    for(h = -4 * c.hopFactor; h < settings.hops; ++h){//let tracks get established before measuring
+        feed(model, s, pos);
+        model.transform(Analysis::TRANSFORM::FFT);
+        model.updateAnalysisResults(Analysis::PARAMETER::MAG);
+        model.beginHop();
+        start = Clock::now();
+        model.detectPeaks();
+        t[0] = elapsed(start);
+        start = Clock::now();
+        model.matchPeaks();
+        t[1] = elapsed(start);
+        start = Clock::now();
+        model.birthTracks();
+        t[2] = elapsed(start);
+        start = Clock::now();
+        model.updateTracks();
+        t[3] = elapsed(start);
+        model.getSynthesis().consume(model.getFrames());//keep the frame queue from filling up
+        if(h >= 0){
+            detect.push_back(t[0]);
+            match.push_back(t[1]);
+            birth.push_back(t[2]);
+            update.push_back(t[3]);
+            total.push_back(t[0] + t[1] + t[2] + t[3]);
+        }
+    }
+    results.push_back(summarize("breakpoint.detect", s.name, c, detect, hopSize));
+    results.push_back(summarize("breakpoint.match", s.name, c, match, hopSize));
+    results.push_back(summarize("breakpoint.birth", s.name, c, birth, hopSize));
+    results.push_back(summarize("breakpoint.update", s.name, c, update, hopSize));
+    results.push_back(summarize("breakpoint", s.name, c, total, hopSize));
+}
+
+//end to end, one channel of processBlock: analysis (every resolution's), breakpoint and resynthesis in host sized blocks
+static void benchProcess(const Signal &s, const Config &c, const Settings &settings, std::vector<Result> &results){
+    SinusoidalModel model(Analysis::WINDOW::GAUSSIAN, c.windowSize, c.hopFactor, BENCHSAMPLERATE, c.padded, Wavetable<float>::WAVEFORM::SINE, 2048,
+                          c.resolutions);
+    std::vector<float> out(BENCHBLOCKSIZE);
+    std::vector<double> times;
+    Clock::time_point start;
+    int b, pos = 0, hopSize = c.windowSize / c.hopFactor;
+    int numBlocks = std::max(1, settings.hops * hopSize / BENCHBLOCKSIZE), warmup = std::max(1, 4 * c.windowSize / BENCHBLOCKSIZE);
+    model.setPrecision(settings.precision);
+    model.setEstimator(settings.estimator);
+    model.init();
+    for(b = -warmup; b < numBlocks; ++b){
+        if(pos + BENCHBLOCKSIZE > (int)s.data.size()){
+            pos = 0;
+        }
+        start = Clock::now();
+        model.process(&s.data[pos], &out[0], BENCHBLOCKSIZE);
+        if(b >= 0){
+            times.push_back(elapsed(start));
+        }
+        pos += BENCHBLOCKSIZE;
+    }
+    results.push_back(summarize("process", s.name, c, times, BENCHBLOCKSIZE));
+}
+
+//Oscillator<float>::next() across a bank of gliding oscillators, with OscillatorBank::render() and
+//SpectralSynthesis::render() alongside for comparison
+static void benchOscillators(const int n, const Settings &settings, std::vector<Result> &results){
+    Wavetable<float> wavetable(Wavetable<float>::WAVEFORM::SINE, 2048);
+    std::vector<Oscillator<float> > oscillators(n);
+    OscillatorBank bank;
+    SpectralSynthesis spectral(BENCHSAMPLERATE, n, 256);
+    std::vector<float> out(BENCHBLOCKSIZE);
+    std::vector<double> next, render, ifft;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> frq(50.0f, 15000.0f), amp(0.0f, 1.0f / n);
+    Clock::time_point start;
+    Config c;
+    Result r;
+    float a, f, sum;
+    int b, i, j, hopSize = 256, numBlocks = std::max(1, settings.hops * hopSize / BENCHBLOCKSIZE);
+    c.windowSize = c.hopFactor = 0;
+    c.resolutions = 1;
+    c.padded = false;
+    bank.init(&wavetable, BENCHSAMPLERATE, n);
+    for(j = 0; j < n; ++j){
+        oscillators[j].init(&wavetable, BENCHSAMPLERATE);
+        a = amp(rng);
+        f = frq(rng);
+        oscillators[j].start(a, f, 0.0f);
+        bank.start(j, a, f, 0.0f);
+        bank.setActive(j, true);
+        bank.setGain(j, 1.0f);
+        spectral.start(j, a, f, 0.0f);
+        spectral.setActive(j, true);
+        spectral.setGain(j, 1.0f);
+    }
+    for(b = -4; b < numBlocks; ++b){
+        if(((b * BENCHBLOCKSIZE) % hopSize) == 0){//new targets every hop, so the interpolation is always running
+            for(j = 0; j < n; ++j){
+                a = amp(rng);
+                f = frq(rng);
+                oscillators[j].update(a, f, 0.0f, hopSize);
+                bank.update(j, a, f, 0.0f, hopSize);
+                spectral.update(j, a, f, 0.0f, hopSize);
+            }
+        }
+        start = Clock::now();
+        for(i = 0; i < BENCHBLOCKSIZE; ++i){
+            sum = 0.0f;
+            for(j = 0; j < n; ++j){
+                sum += oscillators[j].next();
+            }
+            out[i] = sum;
+        }
+        if(b >= 0){
+            next.push_back(elapsed(start));
+        }
+        start = Clock::now();
+        bank.render(&out[0], BENCHBLOCKSIZE);
+        if(b >= 0){
+            render.push_back(elapsed(start));
+        }
+        start = Clock::now();
+        spectral.render(&out[0], BENCHBLOCKSIZE);
+        if(b >= 0){
+            ifft.push_back(elapsed(start));
+        }
+    }
+    const char * stages[] = {"oscillator.next", "oscillatorbank.render", "spectral.render"};
+    std::vector<double> * times[] = {&next, &render, &ifft};
+    for(int k = 0; k < 3; ++k){
+        r = summarize(stages[k], "", c, *times[k], (double)BENCHBLOCKSIZE * n);
+        std::ostringstream name;
+        name << r.stage << "/n" << n;
+        r.name = name.str();
+        results.push_back(r);
+    }
+}
+
+static void benchNoise(const Settings &settings, std::vector<Result> &results){
+    WhiteNoise white;
+    PinkNoise pink;
+    std::vector<float> out(BENCHBLOCKSIZE);
+    std::vector<double> times[2];
+    Clock::time_point start;
+    Config c;
+    Result r;
+    int b, numBlocks = std::max(1, settings.hops * 256 / BENCHBLOCKSIZE);
+    c.windowSize = c.hopFactor = 0;
+    c.padded = false;
+    for(b = -4; b < numBlocks; ++b){
+        start = Clock::now();
+        white.fill(&out[0], BENCHBLOCKSIZE);
+        if(b >= 0){
+            times[0].push_back(elapsed(start));
+        }
+        start = Clock::now();
+        pink.fill(&out[0], BENCHBLOCKSIZE);
+        if(b >= 0){
+            times[1].push_back(elapsed(start));
+        }
+    }
+    const char * stages[] = {"noise.white", "noise.pink"};
+    for(int k = 0; k < 2; ++k){
+        r = summarize(stages[k], "", c, times[k], (double)BENCHBLOCKSIZE);
+        r.name = r.stage;
+        results.push_back(r);
+    }
+}
+
+//////////////////////////////////////////////////////////////
+//  Output
+//////////////////////////////////////////////////////////////
+//one result per line, so a baseline can be read back without a JSON library
+static void writeJSON(std::ostream &out, const Settings &settings, const std::vector<Result> &results){
+    out << "{" << std::endl;
+    out << "  \"suite\": \"smodels-bench\"," << std::endl;
+    out << "  \"precision\": \"" << ((settings.precision == Analysis::PRECISION::FAST)?"fast":"exact") << "\"," << std::endl;
+    out << "  \"estimator\": \"" << ((settings.estimator == Analysis::ESTIMATOR::REASSIGNMENT)?"reassignment":"parabolic") << "\"," << std::endl;
+    out << "  \"sampleRate\": " << BENCHSAMPLERATE << "," << std::endl;
+    out << "  \"results\": [" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    for(size_t i = 0; i < results.size(); ++i){
+        const Result &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"stage\": \"" << r.stage << "\", \"signal\": \"" << r.signal <<
+        "\", \"windowSize\": " << r.windowSize << ", \"hopFactor\": " << r.hopFactor << ", \"padded\": " << (r.padded?"true":"false") <<
+        ", \"count\": " << r.count << ", \"medianNs\": " << r.median << ", \"minNs\": " << r.min << ", \"nsPerSample\": " << r.perSample << "}" <<
+        ((i + 1 < results.size())?",":"") << std::endl;
+    }
+    out << "  ]" << std::endl << "}" << std::endl;
+}
+
+static bool readBaseline(const std::string &path, std::map<std::string, double> &baseline){
+    std::ifstream in(path.c_str());
+    std::string line, key = "\"name\": \"", value = "\"medianNs\": ";
+    size_t a, b;
+    if(!in){
+        std::cout << "Error: can't open baseline " << path << std::endl;
+        return false;
+    }
+    while(std::getline(in, line)){
+        if((a = line.find(key)) == std::string::npos || (b = line.find(value)) == std::string::npos){
+            continue;
+        }
+        a += key.size();
+        baseline[line.substr(a, line.find('"', a) - a)] = atof(line.c_str() + b + value.size());
+    }
+    return true;
+}
+
+//medians more than tolerance slower than the baseline count as regressions. returns # of regressions
+static int compare(const std::map<std::string, double> &baseline, const std::vector<Result> &results, const double tolerance){
+    std::map<std::string, double>::const_iterator found;
+    int numRegressions = 0, numCompared = 0;
+    double ratio;
+    std::cerr << std::fixed << std::setprecision(2);
+    for(size_t i = 0; i < results.size(); ++i){
+        found = baseline.find(results[i].name);
+        if(found == baseline.end() || found->second <= 0.0){
+            continue;
+        }
+        numCompared++;
+        ratio = results[i].median / found->second;
+        if(ratio > 1.0 + tolerance){
+            std::cerr << "REGRESSION " << results[i].name << ": " << found->second << " -> " << results[i].median << " ns (" << ratio << "x)" << std::endl;
+            numRegressions++;
+        }
+        else if(ratio < 1.0 - tolerance){
+            std::cerr << "improved   " << results[i].name << ": " << found->second << " -> " << results[i].median << " ns (" << ratio << "x)" << std::endl;
+        }
+    }
+    std::cerr << numCompared << " of " << results.size() << " results compared against the baseline, " << numRegressions << " regressed by more than " <<
+    (int)(tolerance * 100.0 + 0.5) << "%" << std::endl;
+    return numRegressions;
+}
+
+//////////////////////////////////////////////////////////////
+//  main
+//////////////////////////////////////////////////////////////
+static void usage(){
+    std::cout << "usage: smodels-bench [options]" << std::endl <<
+    "  -o FILE          write the JSON results to FILE instead of stdout" << std::endl <<
+    "  --baseline FILE  compare against an earlier run, exit 1 on any regression" << std::endl <<
+    "  --tolerance X    slowdown allowed before it counts as a regression (default: 0.1)" << std::endl <<
+    "  --windows LIST   window sizes (default: 512,1024,2048,4096)" << std::endl <<
+    "  --hop-factors L  hop factors (default: 2,4,8)" << std::endl <<
+    "  --padding LIST   0 and/or 1 (default: 0,1)" << std::endl <<
+    "  --signals LIST   sweep, chord and/or noise (default: all three)" << std::endl <<
+    "  --oscillators L  oscillator counts for the oscillator stages (default: 16,64,256)" << std::endl <<
+    "  --hops N         measured hops per configuration (default: 256)" << std::endl <<
+    "  --resolutions L  resolution counts for the end to end stage, see SinusoidalModel (default: 1)" << std::endl <<
+    "  --quick          1024 window, hop factor 4, padded only, 64 hops" << std::endl <<
+    "  --exact          libm spectrum instead of the SIMD approximations" << std::endl <<
+    "  --reassign       reassigned peak frequencies, costs a second FFT per hop" << std::endl;
+}
+
+static std::vector<int> parseList(const std::string &list){
+    std::vector<int> values;
+    std::stringstream in(list);
+    std::string item;
+    while(std::getline(in, item, ',')){
+        values.push_back(atoi(item.c_str()));
+    }
+    return values;
+}
+
+int main(int argc, char ** argv){
+    Settings settings;
+    std::vector<Signal> signals;
+    std::vector<Result> results;
+    std::map<std::string, double> baseline;
+    std::vector<int> list;
+    std::string arg;
+    Config c;
+    settings.windowSizes = {512, 1024, 2048, 4096};
+    settings.hopFactors = {2, 4, 8};
+    settings.paddings = {false, true};
+    settings.oscillatorCounts = {16, 64, 256};
+    settings.resolutions = {1};
+    settings.signals = {"sweep", "chord", "noise"};
+    settings.precision = Analysis::PRECISION::FAST;
+    settings.estimator = Analysis::ESTIMATOR::PARABOLIC;
+    settings.hops = 256;
+    settings.tolerance = 0.1;
+
+    for(int a = 1; a < argc; ++a){
+        arg = argv[a];
+        if(arg == "--quick"){
+            settings.windowSizes = {1024};
+            settings.hopFactors = {4};
+            settings.paddings = {true};
+            settings.oscillatorCounts = {64};
+            settings.hops = 64;
+        }
+        else if(arg == "--exact"){
+            settings.precision = Analysis::PRECISION::EXACT;
+        }
+        else if(arg == "--reassign"){
+            settings.estimator = Analysis::ESTIMATOR::REASSIGNMENT;
+        }
+        else if(arg == "-h" || arg == "--help"){
+            usage();
+            return 0;
+        }
+        else if(a + 1 < argc && arg == "-o"){
+            settings.outputPath = argv[++a];
+        }
+        else if(a + 1 < argc && arg == "--baseline"){
+            settings.baselinePath = argv[++a];
+        }
+        else if(a + 1 < argc && arg == "--tolerance"){
+            settings.tolerance = atof(argv[++a]);
+        }
+        else if(a + 1 < argc && arg == "--windows"){
+            settings.windowSizes = parseList(argv[++a]);
+        }
+        else if(a + 1 < argc && arg == "--hop-factors"){
+            settings.hopFactors = parseList(argv[++a]);
+        }
+        else if(a + 1 < argc && arg == "--padding"){
+            list = parseList(argv[++a]);
+            settings.paddings.assign(list.begin(), list.end());
+        }
+        else if(a + 1 < argc && arg == "--oscillators"){
+            settings.oscillatorCounts = parseList(argv[++a]);
+        }
+        else if(a + 1 < argc && arg == "--hops"){
+            settings.hops = atoi(argv[++a]);
+        }
+        else if(a + 1 < argc && arg == "--resolutions"){
+            settings.resolutions = parseList(argv[++a]);
+        }
+        else if(a + 1 < argc && arg == "--signals"){
+            std::stringstream in(argv[++a]);
+            std::string item;
+            settings.signals.clear();
+            while(std::getline(in, item, ',')){
+                settings.signals.push_back(item);
+            }
+        }
+        else{
+            std::cout << "Error: unknown option " << arg << std::endl;
+            usage();
+            return 1;
+        }
+    }
+    for(size_t i = 0; i < settings.windowSizes.size(); ++i){
+        c.windowSize = settings.windowSizes[i];
+        if(c.windowSize < 64 || (c.windowSize & (c.windowSize - 1)) != 0){
+            std::cout << "Error: window sizes must be powers of two >= 64" << std::endl;
+            return 1;
+        }
+        for(size_t j = 0; j < settings.hopFactors.size(); ++j){
+            if(settings.hopFactors[j] < 1 || c.windowSize % settings.hopFactors[j] != 0){
+                std::cout << "Error: hop factors must divide every window size" << std::endl;
+                return 1;
+            }
+        }
+    }
+    if(settings.hops < 1){
+        std::cout << "Error: --hops must be positive" << std::endl;
+        return 1;
+    }
+    for(size_t i = 0; i < settings.resolutions.size(); ++i){
+        if(settings.resolutions[i] < 1 || settings.resolutions[i] > MAXRESOLUTIONS){
+            std::cout << "Error: resolutions must be 1 to " << MAXRESOLUTIONS << std::endl;
+            return 1;
+        }
+    }
+    for(size_t i = 0; i < settings.signals.size(); ++i){
+        if(settings.signals[i] == "sweep"){
+            signals.push_back(makeSweep());
+        }
+        else if(settings.signals[i] == "chord"){
+            signals.push_back(makeChord());
+        }
+        else if(settings.signals[i] == "noise"){
+            signals.push_back(makeNoise());
+        }
+        else{
+            std::cout << "Error: unknown signal " << settings.signals[i] << std::endl;
+            return 1;
+        }
+    }
+
+    for(size_t s = 0; s < signals.size(); ++s){
+        for(size_t i = 0; i < settings.windowSizes.size(); ++i){
+            for(size_t j = 0; j < settings.hopFactors.size(); ++j){
+                for(size_t k = 0; k < settings.paddings.size(); ++k){
+                    c.windowSize = settings.windowSizes[i];
+                    c.hopFactor = settings.hopFactors[j];
+                    c.padded = settings.paddings[k];
+                    c.resolutions = 1;
+                    std::cerr << signals[s].name << "/" << configName(c) << std::endl;
+                    benchAnalysis(signals[s], c, settings, results);
+                    benchBreakpoint(signals[s], c, settings, results);
+                    for(size_t r = 0; r < settings.resolutions.size(); ++r){//the other stages only ever see our own analysis
+                        c.resolutions = settings.resolutions[r];
+                        benchProcess(signals[s], c, settings, results);
+                    }
+                }
+            }
+        }
+    }
+    for(size_t i = 0; i < settings.oscillatorCounts.size(); ++i){
+        if(settings.oscillatorCounts[i] > 0){
+            benchOscillators(settings.oscillatorCounts[i], settings, results);
+        }
+    }
+    benchNoise(settings, results);
+
+    if(settings.outputPath.empty()){
+        writeJSON(std::cout, settings, results);
+    }
+    else{
+        std::ofstream out(settings.outputPath.c_str());
+        if(!out){
+            std::cout << "Error: can't create " << settings.outputPath << std::endl;
+            return 1;
+        }
+        writeJSON(out, settings, results);
+    }
+    if(!settings.baselinePath.empty()){
+        if(!readBaseline(settings.baselinePath, baseline)){
+            return 1;
+        }
+        return (compare(baseline, results, settings.tolerance) == 0)?0:1;
+    }
+    return 0;
+}
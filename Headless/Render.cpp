@@ -0,0 +1,416 @@
+/*
+  ==============================================================================
+
+    Render.cpp
+    Created: 17 Oct 2026 4:59:54am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+//smodels-render: streams WAV files through SinusoidalModel (one per channel) and writes the resynthesis,
+//or with --play resynthesizes SMPF files it wrote earlier without analyzing anything.
+//files are farmed out to a fixed number of threads, one file per thread at a time
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FFTPlans.h"
+#include "Instrumentation.h"
+#include "PartialPlayer.h"
+#include "PartialWriter.h"
+#include "SinusoidalModel.h"
+#include "WavFile.h"
+
+struct RenderSettings{
+    std::string outputDir, wisdomFile;
+    Analysis::PRECISION precision;
+    Analysis::ESTIMATOR estimator;
+    windows::TYPE window;
+    int windowSize, hopFactor, resolutions, blockSize, numThreads;
+    uint64_t seed;
+    float stretch, residual;
+    double startTime;
+    bool padded, spectral, stats, sdif, smpf, play;
+};
+
+struct RenderJob{
+    std::string input, output;
+    double seconds, elapsed;
+    bool ok;
+};
+
+static std::mutex console;
+
+static void usage(){
+    std::cout << "usage: smodels-render [options] input.wav [input.wav ...]" << std::endl <<
+    "       smodels-render --play [options] input.smpf [input.smpf ...]" << std::endl <<
+    "  -o DIR        write results to DIR (default: next to each input, as name_smodels.wav)" << std::endl <<
+    "  -W FILE       load FFTW wisdom from FILE and save anything newly measured back to it" << std::endl <<
+    "  -j N          files to render in parallel (default: # of cores)" << std::endl <<
+    "  -w N          analysis window size, power of two (default: 1024)" << std::endl <<
+    "  -f N          hop factor, window size / hop size (default: 4)" << std::endl <<
+    "  -b N          block size fed to the model (default: 512)" << std::endl <<
+    "  --window NAME hann, gaussian, blackman-harris, kaiser or nuttall (default: gaussian)" << std::endl <<
+    "  -m N          analysis resolutions: 2 adds a 4x window for the bass, 3 a 1/4 one for the treble (default: 1)" << std::endl <<
+    "  --no-padding  don't zero pad the FFT" << std::endl <<
+    "  --exact       libm spectrum instead of the SIMD approximations" << std::endl <<
+    "  --reassign    reassigned peak frequencies instead of parabolic interpolation, try it with --no-padding" << std::endl <<
+    "  --spectral    resynthesize with inverse FFTs instead of the oscillator bank" << std::endl <<
+    "  -r X          add the residual (what the partials miss) back as noise at level X (default: 0, off)" << std::endl <<
+    "  --seed N      seed for the residual noise, channel c uses N + c (default: fixed, renders are repeatable)" << std::endl <<
+    "  --stats       print per stage timings and track counts when done" << std::endl <<
+    "  --sdif        also write each channel's partials as SDIF 1TRC (name_smodels[.chN].sdif)" << std::endl <<
+    "  --smpf        also write each channel's frames as SMPF, for smodels-render --play (name_smodels[.chN].smpf)" << std::endl <<
+    "  --play        inputs are SMPF files, resynthesize them as they are (name_play.wav)" << std::endl <<
+    "  -s X          with --play, stretch time by X without changing pitch (default: 1, the only choice with --spectral)" << std::endl <<
+    "  --start T     with --play, start T seconds into the original" << std::endl;
+}
+
+static void printStats(){
+    instrumentation::Snapshot s;
+    int i;
+    instrumentation::snapshot(s);
+    std::cout << "stage      calls      total s    mean us     max us" << std::endl;
+    for(i = 0; i < instrumentation::numStages; ++i){
+        instrumentation::STAGE stage = (instrumentation::STAGE)i;
+        std::cout << std::left << std::setw(10) << instrumentation::getName(stage) << std::right << std::setw(6) << s.calls[i] <<
+        std::fixed << std::setprecision(3) << std::setw(13) << s.getSeconds(stage) << std::setw(11) << s.getMeanMicroseconds(stage) <<
+        std::setw(11) << s.getMaxMicroseconds(stage) << std::endl;
+    }
+    for(i = 0; i < instrumentation::numCounters; ++i){
+        std::cout << instrumentation::getName((instrumentation::COUNTER)i) << ": " << s.counters[i] << std::endl;
+    }
+    std::cout << "recorded from " << s.numThreads << " threads" << std::endl;
+}
+
+static bool endsWith(const std::string &s, const std::string &end){
+    return s.size() > end.size() && s.compare(s.size() - end.size(), end.size(), end) == 0;
+}
+
+static std::string outputPath(const std::string &input, const std::string &dir, const bool play){
+    std::string name = input, stem;
+    size_t slash = input.find_last_of('/');
+    if(!dir.empty()){
+        name = dir + "/" + ((slash == std::string::npos)?input:input.substr(slash + 1));
+    }
+    stem = name;
+    if(play){
+        return ((endsWith(stem, ".smpf"))?stem.substr(0, stem.size() - 5):stem) + "_play.wav";
+    }
+    if(endsWith(stem, ".wav") || endsWith(stem, ".WAV")){
+        stem = stem.substr(0, stem.size() - 4);
+    }
+    return stem + "_smodels.wav";
+}
+
+static void play(RenderJob &job, const RenderSettings &settings){
+    PartialReader reader;
+    WavWriter writer;
+    PartialPlayer * player;
+    std::vector<float> block;
+    long long frames = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    job.ok = false;
+    job.seconds = job.elapsed = 0.0;
+    if(!reader.open(job.input)){
+        return;
+    }
+    if(!writer.open(job.output, 1, (int)reader.getSamplingRate())){
+        return;
+    }
+    player = new PartialPlayer(reader, Wavetable<float>::WAVEFORM::SINE, 2048);
+    player->getSynthesis().setMode((settings.spectral)?SynthesisEngine::MODE::SPECTRAL:SynthesisEngine::MODE::OSCILLATORS);
+    player->setStretch(settings.stretch);
+    player->seekTime(settings.startTime);
+    block.resize(settings.blockSize);
+    job.ok = true;
+    while(!player->isFinished()){
+        player->process(block.data(), settings.blockSize);
+        if(!writer.write(block.data(), settings.blockSize)){
+            std::lock_guard<std::mutex> lock(console);
+            std::cout << "Error: failed writing " << job.output << std::endl;
+            job.ok = false;
+            break;
+        }
+        frames += settings.blockSize;
+    }
+    job.ok = writer.close() && job.ok;
+    delete player;
+    job.seconds = (double)frames / reader.getSamplingRate();
+    job.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void render(RenderJob &job, const RenderSettings &settings){
+    WavReader reader;
+    WavWriter writer;
+    std::vector<SinusoidalModel *> models;
+    std::vector<PartialWriter *> recorders;
+    std::vector<float> interleaved, channel;
+    std::string stem, suffix;
+    int c, i, frames, numChannels;
+    bool recording = true;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    job.ok = false;
+    job.seconds = job.elapsed = 0.0;
+    if(!reader.open(job.input)){
+        return;
+    }
+    numChannels = reader.getNumChannels();
+    if(!writer.open(job.output, numChannels, reader.getSampleRate())){
+        return;
+    }
+    for(c = 0; c < numChannels; ++c){//plans are shared and planning is locked inside FFTPlans, so no need to serialize this
+        models.push_back(new SinusoidalModel(settings.window, settings.windowSize, settings.hopFactor,
+                                             (float)reader.getSampleRate(), settings.padded, Wavetable<float>::WAVEFORM::SINE, 2048,
+                                             settings.resolutions));
+        models[c]->setPrecision(settings.precision);
+        models[c]->setEstimator(settings.estimator);
+        models[c]->setResidual(settings.residual);
+        models[c]->getSynthesis().setSeed(settings.seed + c);
+        models[c]->getSynthesis().setMode((settings.spectral)?SynthesisEngine::MODE::SPECTRAL:SynthesisEngine::MODE::OSCILLATORS);
+        models[c]->init();
+        if(settings.sdif || settings.smpf){
+            stem = job.output.substr(0, job.output.size() - 4);
+            suffix = (numChannels > 1)?".ch" + std::to_string(c + 1):"";
+            recorders.push_back(new PartialWriter(models[c]->getMaxTracks(), (float)reader.getSampleRate(), settings.windowSize,
+                                                  models[c]->getHopSize(), c));
+            if(!recorders[c]->open((settings.sdif)?stem + suffix + ".sdif":"", (settings.smpf)?stem + suffix + ".smpf":"")){
+                recording = false;
+            }
+            models[c]->setRecorder(recorders[c]);
+        }
+    }
+    interleaved.resize(settings.blockSize * numChannels);
+    channel.resize(settings.blockSize);
+    job.ok = recording;
+    while((frames = reader.read(interleaved.data(), settings.blockSize)) > 0){
+        for(c = 0; c < numChannels; ++c){
+            for(i = 0; i < frames; ++i){
+                channel[i] = interleaved[i * numChannels + c];
+            }
+            models[c]->process(channel.data(), channel.data(), frames);
+            for(i = 0; i < frames; ++i){
+                interleaved[i * numChannels + c] = channel[i];
+            }
+        }
+        if(!writer.write(interleaved.data(), frames)){
+            std::lock_guard<std::mutex> lock(console);
+            std::cout << "Error: failed writing " << job.output << std::endl;
+            job.ok = false;
+            break;
+        }
+    }
+    job.ok = writer.close() && job.ok;
+    for(c = 0; c < (int)recorders.size(); ++c){
+        job.ok = recorders[c]->close() && job.ok;
+        delete recorders[c];
+    }
+    for(c = 0; c < numChannels; ++c){
+        delete models[c];
+    }
+    job.seconds = (double)reader.getNumFrames() / reader.getSampleRate();
+    job.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char ** argv){
+    RenderSettings settings;
+    std::vector<RenderJob> jobs;
+    std::vector<std::thread> threads;
+    std::atomic<int> next(0);
+    std::string arg;
+    double seconds = 0.0, elapsed;
+    int t, numFailed = 0;
+    settings.precision = Analysis::PRECISION::FAST;
+    settings.estimator = Analysis::ESTIMATOR::PARABOLIC;
+    settings.window = windows::TYPE::GAUSSIAN;
+    settings.windowSize = 1024;
+    settings.hopFactor = 4;
+    settings.resolutions = 1;
+    settings.blockSize = 512;
+    settings.numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    settings.padded = true;
+    settings.spectral = false;
+    settings.stats = false;
+    settings.sdif = settings.smpf = settings.play = false;
+    settings.stretch = 1.0;
+    settings.residual = 0.0;
+    settings.seed = NOISEDEFAULTSEED;
+    settings.startTime = 0.0;
+
+    for(int a = 1; a < argc; ++a){
+        arg = argv[a];
+        if((arg == "-o" || arg == "-W" || arg == "-j" || arg == "-w" || arg == "-f" || arg == "-m" || arg == "-b") && a + 1 < argc){
+            if(arg == "-o"){
+                settings.outputDir = argv[++a];
+            }
+            else if(arg == "-W"){
+                settings.wisdomFile = argv[++a];
+            }
+            else{
+                t = atoi(argv[++a]);
+                if(arg == "-j"){
+                    settings.numThreads = t;
+                }
+                else if(arg == "-w"){
+                    settings.windowSize = t;
+                }
+                else if(arg == "-f"){
+                    settings.hopFactor = t;
+                }
+                else if(arg == "-m"){
+                    settings.resolutions = t;
+                }
+                else{
+                    settings.blockSize = t;
+                }
+            }
+        }
+        else if((arg == "-s" || arg == "-r" || arg == "--start" || arg == "--seed") && a + 1 < argc){
+            if(arg == "--seed"){
+                settings.seed = strtoull(argv[++a], nullptr, 0);
+            }
+            else if(arg == "-s"){
+                settings.stretch = (float)atof(argv[++a]);
+            }
+            else if(arg == "-r"){
+                settings.residual = (float)atof(argv[++a]);
+            }
+            else{
+                settings.startTime = atof(argv[++a]);
+            }
+        }
+        else if(arg == "--window" && a + 1 < argc){
+            arg = argv[++a];
+            for(t = 0; t < windows::numTypes && arg != windows::getName((windows::TYPE)t); ++t){
+                ;
+            }
+            if(t == windows::numTypes){
+                std::cout << "Error: unknown window " << arg << std::endl;
+                usage();
+                return 1;
+            }
+            settings.window = (windows::TYPE)t;
+        }
+        else if(arg == "--no-padding"){
+            settings.padded = false;
+        }
+        else if(arg == "--exact"){
+            settings.precision = Analysis::PRECISION::EXACT;
+        }
+        else if(arg == "--reassign"){
+            settings.estimator = Analysis::ESTIMATOR::REASSIGNMENT;
+        }
+        else if(arg == "--spectral"){
+            settings.spectral = true;
+        }
+        else if(arg == "--stats"){
+            settings.stats = true;
+        }
+        else if(arg == "--sdif"){
+            settings.sdif = true;
+        }
+        else if(arg == "--smpf"){
+            settings.smpf = true;
+        }
+        else if(arg == "--play"){
+            settings.play = true;
+        }
+        else if(arg == "-h" || arg == "--help"){
+            usage();
+            return 0;
+        }
+        else if(!arg.empty() && arg[0] == '-'){
+            std::cout << "Error: unknown option " << arg << std::endl;
+            usage();
+            return 1;
+        }
+        else{
+            RenderJob job;
+            job.input = arg;
+            jobs.push_back(job);
+        }
+    }
+    if(jobs.empty()){
+        usage();
+        return 1;
+    }
+    for(t = 0; t < (int)jobs.size(); ++t){//--play can come after the inputs
+        jobs[t].output = outputPath(jobs[t].input, settings.outputDir, settings.play);
+    }
+    if(settings.windowSize < 64 || (settings.windowSize & (settings.windowSize - 1)) != 0 || settings.hopFactor < 1 ||
+       settings.windowSize % settings.hopFactor != 0 || settings.blockSize < 1 || settings.numThreads < 1){
+        std::cout << "Error: window size must be a power of two >= 64 that the hop factor divides, block size and -j must be positive" << std::endl;
+        return 1;
+    }
+    if(settings.resolutions < 1 || settings.resolutions > MAXRESOLUTIONS){
+        std::cout << "Error: resolutions must be 1 to " << MAXRESOLUTIONS << std::endl;
+        return 1;
+    }
+    if(!(settings.stretch > 0.0) || settings.startTime < 0.0 || settings.residual < 0.0){
+        std::cout << "Error: stretch must be positive, the start time and residual level can't be negative" << std::endl;
+        return 1;
+    }
+    if(settings.spectral && settings.stretch != 1.0f){//its grains are a fixed hop apart, however long the frame lasts
+        std::cout << "Error: --spectral can't stretch, leave -s at 1 or use the oscillator bank" << std::endl;
+        usage();
+        return 1;
+    }
+
+    if(!settings.wisdomFile.empty() && !fftplans::setWisdomFile(settings.wisdomFile)){
+        std::cout << "No FFTW wisdom in " << settings.wisdomFile << " yet, it'll be written as plans are measured" << std::endl;
+    }
+    instrumentation::setEnabled(settings.stats);
+    if(settings.stats){
+        instrumentation::getTicksPerSecond();//calibrate before anything starts timing
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    settings.numThreads = std::min(settings.numThreads, (int)jobs.size());
+    for(t = 0; t < settings.numThreads; ++t){
+        threads.push_back(std::thread([&](){
+            int j;
+            while((j = next++) < (int)jobs.size()){
+                if(settings.play){
+                    play(jobs[j], settings);
+                }
+                else{
+                    render(jobs[j], settings);
+                }
+                std::lock_guard<std::mutex> lock(console);
+                if(jobs[j].ok){
+                    std::cout << jobs[j].input << " -> " << jobs[j].output << ": " << std::fixed << std::setprecision(2) <<
+                    jobs[j].seconds << " s in " << jobs[j].elapsed << " s (" << std::setprecision(1) <<
+                    jobs[j].seconds / jobs[j].elapsed << "x realtime)" << std::endl;
+                }
+                else{
+                    std::cout << jobs[j].input << ": failed" << std::endl;
+                }
+            }
+        }));
+    }
+    for(t = 0; t < settings.numThreads; ++t){
+        threads[t].join();
+    }
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for(t = 0; t < (int)jobs.size(); ++t){
+        if(jobs[t].ok){
+            seconds += jobs[t].seconds;
+        }
+        else{
+            numFailed++;
+        }
+    }
+    //throughput across every thread, i.e. seconds of audio per wall clock second
+    std::cout << "rendered " << jobs.size() - numFailed << " of " << jobs.size() << " files, " << std::fixed << std::setprecision(2) <<
+    seconds << " s of audio in " << elapsed << " s on " << settings.numThreads << " threads (" << std::setprecision(1) <<
+    seconds / elapsed << "x realtime)" << std::endl;
+    if(settings.stats){
+        printStats();
+    }
+    return (numFailed == 0)?0:1;
+}
@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    WavFile.cpp
+    Created: 17 Oct 2026 4:59:54am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "WavFile.h"
+#include <algorithm>
+#include <cstring>
+
+#define WAVE_FORMAT_PCM 0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+//WAV is little endian whatever we're running on
+static uint32_t readLE(const unsigned char * b, const int n){
+    uint32_t x = 0;
+    for(int i = n - 1; i >= 0; --i){
+        x = (x << 8) | b[i];
+    }
+    return x;
+}
+static void writeLE(unsigned char * b, uint32_t x, const int n){
+    for(int i = 0; i < n; ++i, x >>= 8){
+        b[i] = (unsigned char)(x & 0xFF);
+    }
+}
+
+//////////////////////////////////////////////////////////////
+//  WavReader
+//////////////////////////////////////////////////////////////
+WavReader::WavReader(){
+    file = nullptr;
+    format = FORMAT::PCM;
+    numChannels = sampleRate = bytesPerSample = 0;
+    numFrames = framesRead = 0;
+    scratch = new unsigned char[WAVBLOCKBYTES];
+}
+
+WavReader::~WavReader(){
+    close();
+    delete[] scratch;
+}
+
+bool WavReader::open(const std::string &path){
+    unsigned char header[12], chunk[8], fmt[40];
+    uint32_t chunkSize, tag = 0, bits = 0;
+    bool haveFormat = false;
+    close();
+    file = fopen(path.c_str(), "rb");
+    if(file == nullptr){
+        std::cout << "Error: can't open " << path << std::endl;
+        return false;
+    }
+    if(fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0){
+        std::cout << "Error: " << path << " is not a WAV file" << std::endl;
+        close();
+        return false;
+    }
+    while(fread(chunk, 1, 8, file) == 8){//walk the chunks until we hit the sample data
+        chunkSize = readLE(chunk + 4, 4);
+        if(memcmp(chunk, "fmt ", 4) == 0){
+            if(chunkSize < 16 || chunkSize > sizeof(fmt) || fread(fmt, 1, chunkSize, file) != chunkSize){
+                break;
+            }
+            tag = readLE(fmt, 2);
+            numChannels = readLE(fmt + 2, 2);
+            sampleRate = readLE(fmt + 4, 4);
+            bits = readLE(fmt + 14, 2);
+            if(tag == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 26){//sub format guid starts with the plain tag
+                tag = readLE(fmt + 24, 2);
+            }
+            haveFormat = true;
+        }
+        else if(memcmp(chunk, "data", 4) == 0){
+            if(!haveFormat){
+                break;
+            }
+            if(tag == WAVE_FORMAT_PCM && (bits == 16 || bits == 24 || bits == 32)){
+                format = FORMAT::PCM;
+            }
+            else if(tag == WAVE_FORMAT_IEEE_FLOAT && (bits == 32 || bits == 64)){
+                format = FORMAT::FLOAT;
+            }
+            else{
+                std::cout << "Error: " << path << " uses an unsupported sample format (" << tag << ", " << bits << " bit)" << std::endl;
+                close();
+                return false;
+            }
+            bytesPerSample = bits / 8;
+            if(numChannels <= 0 || numChannels * bytesPerSample > WAVBLOCKBYTES){
+                break;
+            }
+            numFrames = chunkSize / (numChannels * bytesPerSample);
+            framesRead = 0;
+            return true;
+        }
+        else if(fseek(file, chunkSize + (chunkSize & 1), SEEK_CUR) != 0){//chunks are padded to even sizes
+            break;
+        }
+    }
+    std::cout << "Error: " << path << " has no usable sample data" << std::endl;
+    close();
+    return false;
+}
+
+void WavReader::close(){
+    if(file != nullptr){
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+int WavReader::read(float * samples, const int frames){
+    int i, n, count, total = 0, frameBytes = numChannels * bytesPerSample;
+    const unsigned char * b;
+    uint32_t bits;
+    uint64_t wideBits;
+    int32_t s;
+    double d;
+    float f;
+    while(file != nullptr && total < frames && framesRead < numFrames){
+        count = (int)std::min((int64_t)std::min(frames - total, WAVBLOCKBYTES / frameBytes), numFrames - framesRead);
+        count = (int)fread(scratch, frameBytes, count, file);
+        if(count <= 0){
+            break;
+        }
+        n = count * numChannels;
+        for(i = 0, b = scratch; i < n; ++i, b += bytesPerSample){
+            if(format == FORMAT::FLOAT){
+                if(bytesPerSample == 4){
+                    bits = readLE(b, 4);
+                    memcpy(&f, &bits, 4);
+                    samples[total * numChannels + i] = f;
+                }
+                else{
+                    wideBits = (uint64_t)readLE(b, 4) | ((uint64_t)readLE(b + 4, 4) << 32);
+                    memcpy(&d, &wideBits, 8);
+                    samples[total * numChannels + i] = (float)d;
+                }
+            }
+            else{//left justify so the sign bit lands on top, then scale to [-1, 1)
+                s = (int32_t)(readLE(b, bytesPerSample) << (32 - 8 * bytesPerSample));
+                samples[total * numChannels + i] = (float)(s / 2147483648.0);
+            }
+        }
+        total += count;
+        framesRead += count;
+    }
+    return total;
+}
+
+//////////////////////////////////////////////////////////////
+//  WavWriter
+//////////////////////////////////////////////////////////////
+WavWriter::WavWriter(){
+    file = nullptr;
+    numChannels = sampleRate = 0;
+    framesWritten = 0;
+    scratch = new unsigned char[WAVBLOCKBYTES];
+}
+
+WavWriter::~WavWriter(){
+    close();
+    delete[] scratch;
+}
+
+bool WavWriter::writeHeader(){//44 byte canonical header, IEEE float
+    unsigned char header[44];
+    uint32_t dataBytes = (uint32_t)(framesWritten * numChannels * 4);
+    memcpy(header, "RIFF", 4);
+    writeLE(header + 4, 36 + dataBytes, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    writeLE(header + 16, 16, 4);
+    writeLE(header + 20, WAVE_FORMAT_IEEE_FLOAT, 2);
+    writeLE(header + 22, numChannels, 2);
+    writeLE(header + 24, sampleRate, 4);
+    writeLE(header + 28, sampleRate * numChannels * 4, 4);
+    writeLE(header + 32, numChannels * 4, 2);
+    writeLE(header + 34, 32, 2);
+    memcpy(header + 36, "data", 4);
+    writeLE(header + 40, dataBytes, 4);
+    return fwrite(header, 1, 44, file) == 44;
+}
+
+bool WavWriter::open(const std::string &path, const int nc, const int sr){
+    close();
+    numChannels = nc;
+    sampleRate = sr;
+    framesWritten = 0;
+    file = fopen(path.c_str(), "wb");
+    if(file == nullptr){
+        std::cout << "Error: can't create " << path << std::endl;
+        return false;
+    }
+    return writeHeader();//placeholder sizes until close()
+}
+
+bool WavWriter::write(const float * samples, const int frames){
+    int i, n, count, total = 0, frameBytes = numChannels * 4;
+    uint32_t bits;
+    while(file != nullptr && total < frames){
+        count = std::min(frames - total, WAVBLOCKBYTES / frameBytes);
+        n = count * numChannels;
+        for(i = 0; i < n; ++i){
+            memcpy(&bits, samples + total * numChannels + i, 4);
+            writeLE(scratch + i * 4, bits, 4);
+        }
+        if(fwrite(scratch, frameBytes, count, file) != (size_t)count){
+            return false;
+        }
+        total += count;
+        framesWritten += count;
+    }
+    return file != nullptr;
+}
+
+bool WavWriter::close(){
+    bool ok = true;
+    if(file != nullptr){
+        ok = fseek(file, 0, SEEK_SET) == 0 && writeHeader();
+        ok = (fclose(file) == 0) && ok;
+        file = nullptr;
+    }
+    return ok;
+}
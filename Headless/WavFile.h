@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    WavFile.h
+    Created: 17 Oct 2026 4:59:54am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef WAVFILE_H_INCLUDED
+#define WAVFILE_H_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#define WAVBLOCKBYTES 65536 //scratch space for converting to/from file samples
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  WavReader/WavWriter Classes (streaming RIFF WAVE i/o)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//just enough WAV for the headless tools: 16/24/32 bit integer and 32/64 bit float PCM in (plain or
+//WAVE_FORMAT_EXTENSIBLE), 32 bit float out. samples are interleaved floats in [-1, 1]
+class WavReader{
+public:
+    enum class FORMAT{PCM, FLOAT};
+private:
+    FILE * file;
+    FORMAT format;
+    int numChannels, sampleRate, bytesPerSample;
+    int64_t numFrames, framesRead;
+    unsigned char * scratch;
+public:
+    WavReader();
+    ~WavReader();
+
+    bool open(const std::string &path);
+    void close();
+    int read(float * samples, const int frames);//returns # of frames read, 0 at the end of the data
+
+    //getters
+    int getNumChannels() const{return numChannels;}
+    int getSampleRate() const{return sampleRate;}
+    int64_t getNumFrames() const{return numFrames;}
+};
+
+class WavWriter{
+private:
+    FILE * file;
+    int numChannels, sampleRate;
+    int64_t framesWritten;
+    unsigned char * scratch;
+
+    bool writeHeader();
+public:
+    WavWriter();
+    ~WavWriter();
+
+    bool open(const std::string &path, const int nc, const int sr);
+    bool write(const float * samples, const int frames);
+    bool close();//fills in the chunk sizes
+};
+
+#endif  // WAVFILE_H_INCLUDED
@@ -8,9 +8,15 @@
   ==============================================================================
 */
 #include "Analysis.h"
+#include "FFTPlans.h"
+#include "Instrumentation.h"
 #define CRUMB 0.0000001
-Analysis::Analysis(const WINDOW w, const int ws, const int hf, const int sr, const bool p){
+Analysis::Analysis(const WINDOW w, const int ws, const int hf, const int sr, const bool p, const bool own){
     windowType = w;
+    precision = PRECISION::EXACT;
+    estimator = ESTIMATOR::PARABOLIC;
+    reassigned = false;
+    kernels = spectrum::select();
     padded = p;
     samplingRate = sr;
     windowSize = ws;
@@ -20,64 +26,65 @@ Analysis::Analysis(const WINDOW w, const int ws, const int hf, const int sr, con
     numBins = paddedSize / 2 + 1;
     numWrittenSinceFFT = 0;
     appetite = windowSize;
+    dirty = 0;
     
 	rms = 0.0;
-    inputBuffer = new RingBuffer<float>(windowSize);
-    outputBuffer = new RingBuffer<float>(windowSize);
-    window = new float[windowSize]{0.0};
-	amplitudes = new float[numBins]{0.0};
-    magnitudes = new float[numBins]{0.0};
-    phases = new float[numBins]{0.0};
-    frequencies = new float[numBins];
+    normFactor = denormFactor = ampNormFactor = 1.0;
     samplingRateOverSize = (float)samplingRate / paddedSize;
+    arena = nullptr;
+    forwardPlan = backwardPlan = nullptr;
+    if(own){
+        Arena sizing;
+        carve(sizing);
+        arena = new Arena(sizing.getUsed());
+        carve(*arena);
+        prepare();
+    }
+}
+Analysis::~Analysis(){
+    //the ring buffers don't own their storage, and everything else is freed with the arena
+    if(forwardPlan != nullptr){
+        fftplans::release(forwardPlan);
+        fftplans::release(backwardPlan);
+    }
+    delete arena;
+}
+
+void Analysis::carve(Arena &a){
+    //in the order a hop touches them: input, window, fft, then the spectra detectPeaks reads
+    inputBuffer = a.make<RingBuffer<float>>(a.take<float>(windowSize), windowSize);
+    window = a.take<float>(windowSize);
+    realBuffer = a.take<float>(paddedSize);
+    complexBuffer = a.take<fftwf_complex>(numBins);
+    //reassignment only, it runs the same plan on these
+    derivative = a.take<float>(windowSize);
+    derivativeBuffer = a.take<float>(paddedSize);
+    derivativeSpectrum = a.take<fftwf_complex>(numBins);
+    magnitudes = a.take<float>(numBins);
+    frequencies = a.take<float>(numBins);
+    phases = a.take<float>(numBins);
+    //display and resynthesis only
+    amplitudes = a.take<float>(numBins);
+    outputBuffer = a.make<RingBuffer<float>>(a.take<float>(windowSize), windowSize);
+}
+
+void Analysis::prepare(){
     for(int i = 0; i < numBins; ++i){
         frequencies[i] = i * samplingRateOverSize;
         //std::cout << "Bin " << i << " frq: " << frequencies[i] << std::endl;
     }
     setWindow(windowType);
     
-    //FFTW
-    realBuffer = (float*) fftwf_malloc(sizeof(float) * paddedSize);
-    memset(realBuffer, 0, sizeof(float) * paddedSize);
-    complexBuffer = (fftwf_complex*) fftwf_alloc_complex(sizeof(fftwf_complex) * numBins);
-    memset(complexBuffer, 0, sizeof(fftwf_complex) * numBins);
-    forwardPlan = fftwf_plan_dft_r2c_1d(paddedSize, realBuffer, complexBuffer, FFTW_MEASURE);
-    backwardPlan = fftwf_plan_dft_c2r_1d(paddedSize, complexBuffer, realBuffer, FFTW_MEASURE);
-}
-Analysis::~Analysis(){
-    delete inputBuffer;
-    delete outputBuffer;
-    delete[] window;
-    delete[] magnitudes;
-    delete[] phases;
-    delete[] frequencies;
-    
-    //FFTW
-    fftwf_free(realBuffer);
-    fftwf_free(complexBuffer);
-    fftwf_destroy_plan(forwardPlan);
-    fftwf_destroy_plan(backwardPlan);
+    //FFTW, shared with every other instance of this size, see FFTPlans.h
+    forwardPlan = fftplans::acquire(paddedSize, fftplans::DIRECTION::FORWARD, realBuffer, complexBuffer);
+    backwardPlan = fftplans::acquire(paddedSize, fftplans::DIRECTION::BACKWARD, realBuffer, complexBuffer);
 }
 
 //setters
-void Analysis::setWindow(const WINDOW w){//might support more options later
-	float sigma, denom;
-    for(int i = 0; i < windowSize; ++i){
-        switch(w){
-            case WINDOW::HANN:
-                window[i] = 0.5 * (1 - cos(2 * M_PI * i / float(windowSize)));
-                break;
-			case WINDOW::GAUSSIAN:
-				sigma = windowSize / 8;
-				denom = 1.0 / (2 * sigma * sigma);
-				window[i] = expf(-((windowSize - i) * (windowSize - i)) * denom);
-				break;
-            default:
-                std::cout << "invalid window type. defaulting to rectangle" << std::endl;
-                window[i] = 1.0;
-                break;
-        }
-    }
+void Analysis::setWindow(const WINDOW w){
+    windowType = w;
+    windows::fill(w, window, derivative, windowSize);
+    windows::measure(window, windowSize, paddedSize, table);
 }
 
 //business methods
@@ -88,64 +95,183 @@ bool Analysis::operator() (const float sample){//use this to write samples to th
     return (numWrittenSinceFFT == appetite)?true:false;
 }
 
+bool Analysis::write(const float * samples, const int n){
+    assert(numWrittenSinceFFT + n <= appetite);
+    inputBuffer->write(samples, n);
+    numWrittenSinceFFT += n;
+    return (numWrittenSinceFFT == appetite)?true:false;
+}
+
 float Analysis::operator() (void){//use this to read samples from the output buffer
     return outputBuffer->read();
 }
 
 void Analysis::transform(const TRANSFORM t){
     if(t == TRANSFORM::IFFT){//IFFT
-        fftwf_execute(backwardPlan);//1 means inverse FFT
+        fftwf_execute_dft_c2r(backwardPlan, complexBuffer, realBuffer);
         for(int i = 0; i < windowSize; ++i){
             outputBuffer->write(realBuffer[i]);
         }
     }
     else{//FFT
-		float sample, sum = 0.0;
-        if(appetite != hopSize){
-            //after the first frame, we'll only need hopSize more samples to take another FFT
-            appetite = hopSize; //putting this here so it won't have to check very often. might be a better way
+        capture();
+        execute();
+    }
+}
+
+void Analysis::capture(){
+    capture(*inputBuffer, 0);
+}
+
+void Analysis::capture(const RingBuffer<float> &history, const int delay){
+	float sample, sum = 0.0;
+    instrumentation::ScopedTimer timer(instrumentation::local(), instrumentation::STAGE::CAPTURE);
+    if(appetite != hopSize){
+        //after the first frame, we'll only need hopSize more samples to take another FFT
+        appetite = hopSize; //putting this here so it won't have to check very often. might be a better way
+    }
+    //fill the real buffer with the last windowSize inputs before the delay, oldest first
+    memset(realBuffer, 0, sizeof(float) * paddedSize);
+    history.latest(realBuffer, windowSize, delay);
+    reassigned = estimator == ESTIMATOR::REASSIGNMENT;
+    for(int i = 0; i < windowSize; ++i){
+		sample = realBuffer[i];
+        realBuffer[i] = sample * window[i];//apply window function
+        if(reassigned){
+            derivativeBuffer[i] = sample * derivative[i];
         }
-        //fill the real buffer with new input values
-        memset(realBuffer, 0, sizeof(float) * paddedSize);
-        for(int i = 0; i < windowSize; ++i){
-			sample = inputBuffer->read();
-            realBuffer[i] = sample * window[i];//apply window function
-			sum += (sample * sample);
+		sum += (sample * sample);
+    }
+	rms = sqrt(sum / windowSize);
+    numWrittenSinceFFT = 0;
+}
+
+void Analysis::execute(){
+    instrumentation::ScopedTimer timer(instrumentation::local(), instrumentation::STAGE::FFT);
+    fftwf_execute_dft_r2c(forwardPlan, realBuffer, complexBuffer);//the plan is shared, so always name our own buffers
+    if(reassigned){
+        fftwf_execute_dft_r2c(forwardPlan, derivativeBuffer, derivativeSpectrum);
+    }
+    //amplitudes, magnitudes and phases are derived when someone asks for them, only the norm is needed every frame
+    dirty = flag(PARAMETER::AMP) | flag(PARAMETER::MAG) | flag(PARAMETER::PHS);
+    updateNorm();
+}
+
+void Analysis::discard(){
+    appetite = hopSize;
+    numWrittenSinceFFT = 0;
+}
+
+
+void Analysis::update(const PARAMETER p){
+    if(!(dirty & flag(p))){
+        return;
+    }
+    instrumentation::ScopedTimer timer(instrumentation::local(), instrumentation::STAGE::SPECTRUM);
+    switch(p){
+        case PARAMETER::AMP:
+            updateAmplitudes();
+            break;
+        case PARAMETER::MAG:
+            updateMagnitudes();
+            break;
+        case PARAMETER::PHS:
+            updatePhases();
+            break;
+        default:
+            break;
+    }
+    dirty &= ~flag(p);
+}
+
+float Analysis::getPhase(const int bin) const{
+    if(!(dirty & flag(PARAMETER::PHS))){
+        return phases[bin];
+    }
+    if(precision == PRECISION::FAST){
+        return (spectrum::fastAtan2(complexBuffer[bin][1], complexBuffer[bin][0]) + M_PI) / (2.0 * M_PI);
+    }
+    return (atan2f(complexBuffer[bin][1], complexBuffer[bin][0]) + M_PI) / (2.0 * M_PI);
+}
+
+//X'/X = i(w - w0) for a steady sinusoid at w0, X' taken under dw/dn: the whole frequency error, from one bin
+float Analysis::getFrequencyOffset(const int bin) const{
+    float re = complexBuffer[bin][0], im = complexBuffer[bin][1], power = re * re + im * im;
+    if(!(power > 0.0f)){
+        return 0.0f;
+    }
+    //-Im(X' conj(X)) / |X|^2 is in radians per sample
+    return -(derivativeSpectrum[bin][1] * re - derivativeSpectrum[bin][0] * im) / power * paddedSize / (2.0f * M_PI);
+}
+
+//ignoring dc & nyquist throughout. amplitudes are divided by windowSize and multiplied by two
+void Analysis::updateNorm(){
+    float real, imag, power, maxPower = 0.0, maxAmp, scaleFactor = 1.0 / (numBins - 1);
+    if(precision == PRECISION::FAST){
+        maxPower = kernels.peak(complexBuffer, 1, numBins - 1);
+    }
+    else{
+        for(int i = 1; i < numBins - 1; ++i){//sqrt is monotonic, so the loudest bin has the most power
+            real = complexBuffer[i][0];
+            imag = complexBuffer[i][1];
+            power = real * real + imag * imag;
+            if(power > maxPower){
+                maxPower = power;
+            }
         }
-		rms = sqrt(sum / windowSize);
-        fftwf_execute(forwardPlan);//0 means forward FFT
-        numWrittenSinceFFT = 0;
-        updateSpectrum();//update mag, phs values in this frame for each bin
     }
+    maxAmp = 2.0 * sqrt(maxPower) * scaleFactor;
+    normFactor = 1.0 / maxAmp;
+    denormFactor = maxAmp;
 }
 
+void Analysis::updateAmplitudes(){
+    float real, imag, scaleFactor = 1.0 / (numBins - 1);
+    ampNormFactor = normFactor;
+    if(precision == PRECISION::FAST){
+        kernels.amplitudes(complexBuffer, amplitudes, 1, numBins - 1, scaleFactor);
+        return;
+    }
+    for(int i = 1; i < numBins - 1; ++i){
+        real = complexBuffer[i][0];
+        imag = complexBuffer[i][1];
+		amplitudes[i] = 2.0 * sqrt(real * real + imag * imag) * scaleFactor;
+    }
+}
 
-void Analysis::updateSpectrum(){
-    int i = 1; //ignoring dc & nyquist
-    float real, imag, amp, maxAmp = -MAXFLOAT, scaleFactor = 1.0 / (numBins - 1);
-    for(; i < numBins - 1; ++i){//before calculating magnitude, divide by windowSize and multiply by two
+void Analysis::updateMagnitudes(){//normalized, in dB
+    float real, imag, amp, scaleFactor = 1.0 / (numBins - 1);
+    if(precision == PRECISION::FAST){
+        kernels.magnitudes(complexBuffer, magnitudes, 1, numBins - 1, 2.0f * scaleFactor * normFactor, CRUMB);
+        return;
+    }
+    for(int i = 1; i < numBins - 1; ++i){
         real = complexBuffer[i][0];
         imag = complexBuffer[i][1];
 		amp = 2.0 * sqrt(real * real + imag * imag) * scaleFactor;
-        if(amp > maxAmp){
-            maxAmp = amp;
-			//std::cout << "max amp: " << maxMag << std::endl;
-        }
-		//std::cout << "amp: " << amp << std::endl;
-		amplitudes[i] = amp;
+		magnitudes[i] = 20.0 * log10f(amp * normFactor + CRUMB);
+    }
+}
+
+void Analysis::updatePhases(){
+    float real, imag;
+    if(precision == PRECISION::FAST){
+        kernels.phases(complexBuffer, phases, 1, numBins - 1);
+        return;
+    }
+    for(int i = 1; i < numBins - 1; ++i){
+        real = complexBuffer[i][0];
+        imag = complexBuffer[i][1];
         phases[i] = (atan2f(imag, real) + M_PI) / (2.0 * M_PI);
     }
-	//normalize magnitudes and convert to dB
-	normFactor = 1.0 / maxAmp;
-	denormFactor = maxAmp;
-	for(i = 1; i < numBins - 1; ++i){
-		magnitudes[i] = 20.0 * log10f(amplitudes[i] * normFactor + CRUMB);
-		//std::cout << "mag: " << magnitudes[i] << std::endl;
-	}
 }
 
-void Analysis::init(){
+void Analysis::init(){//back to how it was built, so nothing from before shows up in the next frame
+    inputBuffer->clear();
+    outputBuffer->clear();
     memset(realBuffer, 0, sizeof(float) * paddedSize);
-    memset(complexBuffer, 0, sizeof(float) * numBins);
+    memset(complexBuffer, 0, sizeof(fftwf_complex) * numBins);
     numWrittenSinceFFT = 0;
+    appetite = windowSize;
+    dirty = flag(PARAMETER::AMP) | flag(PARAMETER::MAG) | flag(PARAMETER::PHS);
 }
\ No newline at end of file
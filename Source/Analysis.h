@@ -17,7 +17,10 @@
 #include <cstdlib>
 #include <iostream>
 #include "fftw3.h"
+#include "Arena.h"
 #include "RingBuffer.h"
+#include "SpectrumKernels.h"
+#include "Window.h"
 
 //////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////
@@ -28,35 +31,73 @@ class Analysis{
 public:
     enum class TRANSFORM{FFT, IFFT};
     enum class PARAMETER{REAL, IMAG, AMP, MAG, PHS, FRQ, RMS};
-    enum class WINDOW{HANN, GAUSSIAN};
+    typedef windows::TYPE WINDOW;
+    enum class PRECISION{EXACT, FAST};//FAST: SIMD spectrum with polynomial atan2/log, see SpectrumKernels.h
+    //how a peak's frequency is refined between bins. REASSIGNMENT also transforms the input under the window's
+    //derivative, and reads the offset from the two spectra at the peak bin (Auger & Flandrin's frequency
+    //reassignment). unlike PARABOLIC it's exact for a steady sinusoid without any zero padding
+    enum class ESTIMATOR{PARABOLIC, REASSIGNMENT};
 private:
     int samplingRate, windowSize, hopSize, hopFactor, paddedSize, numBins, numWrittenSinceFFT, appetite;
-    float rms, normFactor, denormFactor, samplingRateOverSize;
-    bool padded;
+    unsigned int dirty;//one bit per PARAMETER, set when the FFT runs and cleared as each spectrum is derived
+    float rms, normFactor, denormFactor, ampNormFactor, samplingRateOverSize;
+    bool padded, reassigned;//reassigned: the frame that was captured has a derivative spectrum too
     WINDOW windowType;
+    PRECISION precision;
+    ESTIMATOR estimator;
+    spectrum::Kernels kernels;
+    Arena * arena;//only when we own our storage
     RingBuffer<float> * inputBuffer;
     RingBuffer<float> * outputBuffer;
     float * realBuffer;
     fftwf_complex * complexBuffer;
-    fftwf_plan forwardPlan, backwardPlan;
+    fftwf_plan forwardPlan, backwardPlan;//shared, only ever run on realBuffer/complexBuffer through the new array interface
     
     float * window;
+    float * derivative;//dw/dn, the reassignment window
+    float * derivativeBuffer;
+    fftwf_complex * derivativeSpectrum;
+    windows::Table table;//measured from the window, see Window.h
 	float * amplitudes;
     float * magnitudes;
     float * phases;
     float * frequencies;
+
+    static unsigned int flag(const PARAMETER p){return 1u << (int)p;}
+    void updateNorm();
+    void updateAmplitudes();
+    void updateMagnitudes();
+    void updatePhases();
 public:
-    Analysis(const WINDOW w = WINDOW::HANN, const int ws = 1024, const int hf = 4, const int sr = 44100, const bool p = true);
+    //own = false leaves the arrays to whoever owns us: carve() them out of their arena, then prepare()
+    Analysis(const WINDOW w = WINDOW::HANN, const int ws = 1024, const int hf = 4, const int sr = 44100, const bool p = true,
+             const bool own = true);
     ~Analysis();
+    void carve(Arena &a);//lay our arrays out in a, a measuring arena only counts them
+    void prepare();//fill in the frequencies and window, acquire the plans. after carving from a real arena
     
     //getters
     int getWindowSize() const{return windowSize;}
+    int getHopSize() const{return hopSize;}
     int getNumBins() const{return numBins;}
+    const float * getWindow() const{return window;}
+    const windows::Table & getWindowTable() const{return table;}
     int getAppetite() const{return appetite;}
+    int getSamplesUntilFFT() const{return appetite - numWrittenSinceFFT;}
 	float getRMS() const{return rms;}
     float getNormFactor() const{return normFactor;}
 	float getDenormFactor() const{return denormFactor;}
+	float getAmpNormFactor() const{return ampNormFactor;}//normFactor of the frame the amplitudes came from
+    //amplitude of a sinusoid that peaks at a in amplitudes: the window's coherent gain and the padding taken out
+    float getSineGain() const{return (numBins - 1) / (table.coherentGain * windowSize);}
 	float getSamplingRateOverSize() const{return samplingRateOverSize;}
+    PRECISION getPrecision() const{return precision;}
+    ESTIMATOR getEstimator() const{return estimator;}
+    bool isReassigned() const{return reassigned;}//the current frame can be asked for getFrequencyOffset()
+    bool isStale(const PARAMETER p) const{return (dirty & flag(p)) != 0;}
+    float getPhase(const int bin) const;//single bin, computed on the spot if the phase spectrum hasn't been
+    float getFrequencyOffset(const int bin) const;//reassigned frequency minus the bin's, in bins. reassigned frames only
+    //the spectra below are only current once update() has been called for them this frame
     float & getAmplitudes() const{return *amplitudes;}
     float & getMagnitudes() const{return *magnitudes;}
     float & getPhases() const{return *phases;}
@@ -68,13 +109,21 @@ public:
 
     //setters
     void setWindow(const WINDOW w);
+    void setPrecision(const PRECISION p){precision = p;}
+    void setEstimator(const ESTIMATOR e){estimator = e;}//from the next capture
     
     //business & utility methods
     bool operator() (const float sample);//use this to write samples to the input buffer
+    bool write(const float * samples, const int n);//block version, n must not run past the next FFT
     float operator() (void);//use this to read samples from the output buffer
     void transform(const TRANSFORM t);
-    void updateSpectrum();
-    void init();
+    //transform(FFT) in two halves, so the FFT can run off the audio thread once the input is copied out
+    void capture();//window the latest input into the FFT buffer
+    void capture(const RingBuffer<float> &history, const int delay);//same, from someone else's input, ending delay samples back
+    void execute();//forward FFT of the captured frame
+    void discard();//skip the frame that's ready without capturing it
+    void update(const PARAMETER p);//derive AMP, MAG or PHS for the current frame, if it hasn't been already
+    void init();//clear the input and start over from a full window, not realtime safe
 };
 
 #endif  // ANALYSIS_H_INCLUDED
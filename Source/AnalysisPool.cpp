@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    AnalysisPool.cpp
+    Created: 17 Oct 2026 4:51:19am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "AnalysisPool.h"
+#include "SinusoidalModel.h"
+
+AnalysisPool::AnalysisPool(const int mj, const int nw){
+    maxJobs = mj;
+    numJobs.store(0);
+    numWorkers = std::max(nw, 1);
+    jobs = new Job[maxJobs];
+    for(int j = 0; j < maxJobs; ++j){
+        jobs[j].state.store((int)STATE::IDLE);
+        jobs[j].model = nullptr;
+    }
+    running.store(true);
+    workers = new std::thread[numWorkers];
+    for(int i = 0; i < numWorkers; ++i){
+        workers[i] = std::thread(&AnalysisPool::work, this);
+    }
+}
+
+AnalysisPool::~AnalysisPool(){
+    running.store(false);
+    wake.notify_all();
+    for(int i = 0; i < numWorkers; ++i){
+        workers[i].join();
+    }
+    delete[] workers;
+    delete[] jobs;
+}
+
+int AnalysisPool::attach(SinusoidalModel * m){
+    SinusoidalModel * free;
+    int n;
+    for(int j = 0; j < maxJobs; ++j){
+        free = nullptr;
+        if(jobs[j].model.compare_exchange_strong(free, m)){
+            jobs[j].state.store((int)STATE::IDLE);
+            n = numJobs.load();
+            while(j >= n && !numJobs.compare_exchange_weak(n, j + 1)){//publishes the slot to the workers
+                ;
+            }
+            return j;
+        }
+    }
+    std::cout << "Error: analysis pool is full" << std::endl;
+    return -1;
+}
+
+void AnalysisPool::detach(const int j){
+    wait(j);
+    jobs[j].state.store((int)STATE::IDLE);
+    jobs[j].model.store(nullptr);
+}
+
+bool AnalysisPool::submit(const int j){
+    int idle = (int)STATE::IDLE;
+    if(!jobs[j].state.compare_exchange_strong(idle, (int)STATE::PENDING, std::memory_order_release)){
+        return false;
+    }
+    wake.notify_one();
+    return true;
+}
+
+bool AnalysisPool::collect(const int j){
+    int done = (int)STATE::DONE;
+    return jobs[j].state.compare_exchange_strong(done, (int)STATE::IDLE, std::memory_order_acquire);
+}
+
+void AnalysisPool::wait(const int j){
+    while(jobs[j].state.load(std::memory_order_acquire) == (int)STATE::PENDING ||
+          jobs[j].state.load(std::memory_order_acquire) == (int)STATE::RUNNING){
+        std::this_thread::yield();
+    }
+}
+
+void AnalysisPool::work(){
+    int j, n, pending, claimed;
+    while(running.load()){
+        claimed = 0;
+        n = numJobs.load();
+        for(j = 0; j < n; ++j){//claim anything pending, the cas makes sure only one worker gets it
+            pending = (int)STATE::PENDING;
+            if(jobs[j].state.compare_exchange_strong(pending, (int)STATE::RUNNING, std::memory_order_acquire)){
+                jobs[j].model.load()->analyze();
+                jobs[j].state.store((int)STATE::DONE, std::memory_order_release);
+                claimed++;
+            }
+        }
+        if(claimed == 0){
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    AnalysisPool.h
+    Created: 17 Oct 2026 4:51:19am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef ANALYSISPOOL_H_INCLUDED
+#define ANALYSISPOOL_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+class SinusoidalModel;
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  AnalysisPool Class (runs models' hop analysis on worker threads)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//one job slot per model, allocated up front. the audio thread only ever does atomic loads/stores on
+//its slot (plus an unlocked notify), so it never waits on a worker. workers also wake up on a short
+//timeout, so a notify that slips in before a worker starts waiting just costs a millisecond
+class AnalysisPool{
+public:
+    enum class STATE{IDLE, PENDING, RUNNING, DONE};
+private:
+    struct Job{
+        std::atomic<int> state;
+        std::atomic<SinusoidalModel *> model;//nullptr while the slot is free
+    };
+    Job * jobs;
+    std::thread * workers;
+    int maxJobs, numWorkers;
+    std::atomic<int> numJobs;//high water mark, workers only look at slots below it
+    std::atomic<bool> running;
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    void work();
+public:
+    AnalysisPool(const int mj, const int nw);
+    ~AnalysisPool();
+
+    //not realtime safe. attach a model before it starts processing, returns its job slot (or -1 if the pool is full).
+    //detach gives the slot back once the model is done with it, i.e. after wait()
+    int attach(SinusoidalModel * m);
+    void detach(const int j);
+
+    //getters
+    int getNumWorkers() const{return numWorkers;}
+    STATE getState(const int j) const{return (STATE)jobs[j].state.load(std::memory_order_acquire);}
+    bool isBusy(const int j) const{return getState(j) != STATE::IDLE;}
+
+    //audio thread
+    bool submit(const int j);//false if the slot's last job hasn't been collected
+    bool collect(const int j);//true (and frees the slot) if the slot's job has finished
+
+    //not realtime safe, blocks until the slot's job (if any) has finished
+    void wait(const int j);
+};
+
+#endif  // ANALYSISPOOL_H_INCLUDED
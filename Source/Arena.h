@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    Arena.h
+    Created: 17 Oct 2026 5:38:05am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <utility>
+#include "SIMD.h"
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  Arena Class (one block, carved up in order)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//every array gets its own cache line aligned slice of a single zeroed allocation. sizes are worked out by
+//running the same carving code twice: first against a measuring arena (size 0), which hands out nullptr
+//and only counts, then against a real one of getUsed() bytes. nothing taken from an arena is destroyed,
+//the block is just freed, so only use it for types whose destructors don't matter
+class Arena{
+private:
+    unsigned char * base;
+    size_t capacity, used;
+public:
+    Arena(const size_t n = 0){//0: measuring
+        capacity = n;
+        used = 0;
+        base = nullptr;
+        if(capacity > 0){
+            base = (unsigned char *)simd::alignedAlloc(capacity);
+            memset(base, 0, capacity);
+        }
+    }
+    ~Arena(){
+        simd::alignedFree(base);
+    }
+
+    //n default constructed Ts, nullptr while measuring
+    template <class T> T * take(const int n){
+        size_t offset = (used + SIMD_ALIGNMENT - 1) & ~(size_t)(SIMD_ALIGNMENT - 1);
+        T * p;
+        used = offset + sizeof(T) * n;
+        if(base == nullptr){
+            return nullptr;
+        }
+        assert(used <= capacity);
+        p = (T *)(base + offset);
+        for(int i = 0; i < n; ++i){
+            new(p + i) T();
+        }
+        return p;
+    }
+    //a single T, constructed in place from args
+    template <class T, class... Args> T * make(Args&&... args){
+        size_t offset = (used + SIMD_ALIGNMENT - 1) & ~(size_t)(SIMD_ALIGNMENT - 1);
+        used = offset + sizeof(T);
+        if(base == nullptr){
+            return nullptr;
+        }
+        assert(used <= capacity);
+        return new(base + offset) T(std::forward<Args>(args)...);
+    }
+
+    //getters
+    bool isMeasuring() const{return base == nullptr;}
+    size_t getUsed() const{return used;}
+    size_t getCapacity() const{return capacity;}
+};
+
+#endif  // ARENA_H_INCLUDED
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    FFTPlans.cpp
+    Created: 17 Oct 2026 5:27:48am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "FFTPlans.h"
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+namespace fftplans{
+    struct Entry{
+        int n, alignment, references;//alignment: fftwf_alignment_of the buffers, 0 when SIMD aligned
+        DIRECTION direction;
+        fftwf_plan plan;
+        Entry * next;
+    };
+
+    static std::mutex planner;//guards everything below and every call into FFTW's planner
+    static Entry * entries = nullptr;
+    static std::string wisdomFile;
+
+    fftwf_plan acquire(const int n, const DIRECTION d, float * real, fftwf_complex * complex){
+        std::lock_guard<std::mutex> lock(planner);
+        int alignment = std::max(fftwf_alignment_of(real), fftwf_alignment_of((float *)complex));
+        unsigned int flags = FFTW_MEASURE | ((alignment != 0)?FFTW_UNALIGNED:0);
+        float * r;
+        fftwf_complex * c;
+        Entry * e;
+        for(e = entries; e != nullptr; e = e->next){
+            if(e->n == n && e->direction == d && e->alignment == alignment){
+                e->references++;
+                return e->plan;
+            }
+        }
+        //measuring scribbles over the buffers, so plan on scratch ones and keep the caller's intact
+        r = fftwf_alloc_real(n);
+        c = fftwf_alloc_complex(n / 2 + 1);
+        e = new Entry;
+        e->n = n;
+        e->alignment = alignment;
+        e->references = 1;
+        e->direction = d;
+        e->plan = (d == DIRECTION::FORWARD)?fftwf_plan_dft_r2c_1d(n, r, c, flags):fftwf_plan_dft_c2r_1d(n, c, r, flags);
+        e->next = entries;
+        entries = e;
+        fftwf_free(r);
+        fftwf_free(c);
+        if(!wisdomFile.empty() && !fftwf_export_wisdom_to_filename(wisdomFile.c_str())){
+            std::cout << "Error: couldn't write FFTW wisdom to " << wisdomFile << std::endl;
+        }
+        return e->plan;
+    }
+
+    void release(fftwf_plan p){
+        std::lock_guard<std::mutex> lock(planner);
+        for(Entry * e = entries; e != nullptr; e = e->next){
+            if(e->plan == p){
+                e->references--;
+                return;
+            }
+        }
+    }
+
+    void purge(){
+        std::lock_guard<std::mutex> lock(planner);
+        Entry ** link = &entries, * e;
+        while((e = *link) != nullptr){
+            if(e->references == 0){
+                *link = e->next;
+                fftwf_destroy_plan(e->plan);
+                delete e;
+            }
+            else{
+                link = &e->next;
+            }
+        }
+    }
+
+    bool setWisdomFile(const std::string &path){
+        std::lock_guard<std::mutex> lock(planner);
+        wisdomFile = path;
+        return !path.empty() && fftwf_import_wisdom_from_filename(path.c_str()) != 0;
+    }
+
+    std::string getWisdomFile(){
+        std::lock_guard<std::mutex> lock(planner);
+        return wisdomFile;
+    }
+
+    int getNumPlans(){
+        std::lock_guard<std::mutex> lock(planner);
+        int n = 0;
+        for(Entry * e = entries; e != nullptr; e = e->next){
+            n++;
+        }
+        return n;
+    }
+}
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    FFTPlans.h
+    Created: 17 Oct 2026 5:27:48am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef FFTPLANS_H_INCLUDED
+#define FFTPLANS_H_INCLUDED
+
+#include <string>
+#include "fftw3.h"
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  Shared FFTW plans
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//one plan per (size, direction, alignment) for the whole process. every Analysis and SpectralSynthesis
+//of the same size shares it and runs it on its own buffers with fftwf_execute_dft_r2c/c2r, which FFTW
+//allows from any number of threads at once. only the planner itself isn't thread safe, so acquire(),
+//release() and the wisdom calls all go through one lock.
+//
+//with a wisdom file set, anything FFTW_MEASURE works out is written back to it straight away, so the
+//next process to load it plans from wisdom instead of timing transforms again
+namespace fftplans{
+    enum class DIRECTION{FORWARD, BACKWARD};//real to complex, complex to real
+
+    //not realtime safe. the plan suits any pair of buffers with the same alignment as real and complex
+    //(SIMD aligned if they came from fftwf_malloc). backward plans are free to overwrite their input
+    fftwf_plan acquire(const int n, const DIRECTION d, float * real, fftwf_complex * complex);
+    void release(fftwf_plan p);//plans stay registered at zero references, see purge()
+    void purge();//destroy every plan nothing holds any more
+
+    //imports path if it exists and exports to it whenever something new is measured. false if nothing was read
+    bool setWisdomFile(const std::string &path);
+    std::string getWisdomFile();
+    int getNumPlans();
+}
+
+#endif  // FFTPLANS_H_INCLUDED
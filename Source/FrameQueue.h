@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    FrameQueue.h
+    Created: 17 Oct 2026 4:53:46am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef FRAMEQUEUE_H_INCLUDED
+#define FRAMEQUEUE_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+
+//lock-free single producer/single consumer queue of preallocated frames. the producer fills the slot
+//write() hands it and publishes it with push(), the consumer reads front() in place and frees it with pop(),
+//so nothing is copied or allocated once it's built. T needs a constructor taking the slot capacity
+template <class T>
+class FrameQueue {
+private:
+    uint32_t size, mask;
+    std::atomic<uint32_t> readPos, writePos;//free running, only ever advanced by their own side
+    T ** slots;
+public:
+    FrameQueue(const int s, const int capacity){
+        size = s; //size must be power of two!
+        mask = size - 1;
+        slots = new T*[size];
+        for(uint32_t i = 0; i < size; ++i){
+            slots[i] = new T(capacity);
+        }
+        readPos.store(0);
+        writePos.store(0);
+    }
+    ~FrameQueue(){
+        for(uint32_t i = 0; i < size; ++i){
+            delete slots[i];
+        }
+        delete[] slots;
+    }
+    //producer
+    T * write(){//next free slot, or nullptr if the consumer has fallen a whole queue behind
+        uint32_t w = writePos.load(std::memory_order_relaxed);
+        if(w - readPos.load(std::memory_order_acquire) == size){
+            return nullptr;
+        }
+        return slots[w & mask];
+    }
+    void push(){
+        writePos.store(writePos.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    //consumer
+    const T * front() const{//oldest published frame, or nullptr if there isn't one
+        uint32_t r = readPos.load(std::memory_order_relaxed);
+        if(r == writePos.load(std::memory_order_acquire)){
+            return nullptr;
+        }
+        return slots[r & mask];
+    }
+    void pop(){
+        readPos.store(readPos.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    //either side, only a snapshot
+    int getNumFrames() const{
+        return (int)(writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_acquire));
+    }
+    void clear(){//only when neither side is running
+        readPos.store(writePos.load());
+    }
+};
+
+#endif  // FRAMEQUEUE_H_INCLUDED
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    Instrumentation.cpp
+    Created: 17 Oct 2026 5:05:18am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "Instrumentation.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace instrumentation{
+    //static storage is zeroed before anything runs, so every slot starts out free and empty
+    static Slot slots[INSTRUMENTATIONSLOTS];
+    static std::atomic<bool> enabled(SMODELS_INSTRUMENTATION != 0);
+    static std::atomic<uint64_t> calibration(0);//ticks per second, 0 until measured
+
+    Slot * local(){
+        size_t id, expected;
+        int i, probe;
+        if(!SMODELS_INSTRUMENTATION || !enabled.load(std::memory_order_relaxed)){
+            return nullptr;
+        }
+        //hashing the thread id is just pthread_self() underneath. unlike thread_local this can't allocate
+        //the first time the audio thread gets here from inside a dynamically loaded plugin
+        id = std::hash<std::thread::id>()(std::this_thread::get_id());
+        id = (id == 0)?1:id;
+        //slots are never released, so a thread's own slot is always before the first free one it probes
+        for(i = 0; i < INSTRUMENTATIONSLOTS - 1; ++i){
+            probe = (int)((id + i) % (INSTRUMENTATIONSLOTS - 1));
+            expected = slots[probe].owner.load(std::memory_order_acquire);
+            if(expected == id){
+                return &slots[probe];
+            }
+            if(expected == 0){
+                if(slots[probe].owner.compare_exchange_strong(expected, id, std::memory_order_acq_rel)){
+                    return &slots[probe];
+                }
+                if(expected == id){
+                    return &slots[probe];
+                }
+            }
+        }
+        return &slots[INSTRUMENTATIONSLOTS - 1];//everyone else shares, fetch_add keeps the sums right
+    }
+
+    void snapshot(Snapshot &s){
+        int i, j;
+        s.numThreads = 0;
+        s.ticksPerSecond = getTicksPerSecond();
+        for(j = 0; j < numStages; ++j){
+            s.stageTicks[j] = s.calls[j] = s.maxTicks[j] = 0;
+        }
+        for(j = 0; j < numCounters; ++j){
+            s.counters[j] = 0;
+        }
+        for(i = 0; i < INSTRUMENTATIONSLOTS; ++i){
+            Slot &slot = slots[i];
+            if(slot.owner.load(std::memory_order_acquire) != 0){
+                s.numThreads++;
+            }
+            for(j = 0; j < numStages; ++j){
+                s.stageTicks[j] += slot.stageTicks[j].load(std::memory_order_relaxed);
+                s.calls[j] += slot.calls[j].load(std::memory_order_relaxed);
+                s.maxTicks[j] = std::max(s.maxTicks[j], (uint64_t)slot.maxTicks[j].load(std::memory_order_relaxed));
+            }
+            for(j = 0; j < numCounters; ++j){
+                if(j == (int)COUNTER::MAXACTIVETRACKS){
+                    s.counters[j] = std::max(s.counters[j], (uint64_t)slot.counters[j].load(std::memory_order_relaxed));
+                }
+                else{
+                    s.counters[j] += slot.counters[j].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    void reset(){
+        int i, j;
+        for(i = 0; i < INSTRUMENTATIONSLOTS; ++i){
+            for(j = 0; j < numStages; ++j){
+                slots[i].stageTicks[j].store(0, std::memory_order_relaxed);
+                slots[i].calls[j].store(0, std::memory_order_relaxed);
+                slots[i].maxTicks[j].store(0, std::memory_order_relaxed);
+            }
+            for(j = 0; j < numCounters; ++j){
+                slots[i].counters[j].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void setEnabled(const bool e){
+        enabled.store(e && SMODELS_INSTRUMENTATION, std::memory_order_relaxed);
+    }
+
+    bool isEnabled(){
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    double getTicksPerSecond(){
+        uint64_t rate = calibration.load(std::memory_order_relaxed);
+        if(rate == 0){
+#if SIMD_X86 || (defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__)))
+            uint64_t t0, t1;
+            std::chrono::steady_clock::time_point c0, c1;
+            //count ticks across a short sleep. the TSC is invariant on anything we'd run on, so once is enough
+            c0 = std::chrono::steady_clock::now();
+            t0 = ticks();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            c1 = std::chrono::steady_clock::now();
+            t1 = ticks();
+            rate = (uint64_t)((t1 - t0) / std::chrono::duration<double>(c1 - c0).count());
+#else
+            rate = 1000000000;
+#endif
+            calibration.store(rate, std::memory_order_relaxed);
+        }
+        return (double)rate;
+    }
+
+    const char * getName(const STAGE s){
+        static const char * names[] = {"capture", "fft", "spectrum", "detect", "match", "birth", "residual", "update", "render"};
+        return names[(int)s];
+    }
+
+    const char * getName(const COUNTER c){
+        static const char * names[] = {"peaks", "sidelobes", "born", "killed", "stolen", "activeTracks", "maxActiveTracks",
+                                       "droppedHops", "droppedFrames", "renderedSamples"};
+        return names[(int)c];
+    }
+}
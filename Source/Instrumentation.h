@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    Instrumentation.h
+    Created: 17 Oct 2026 5:05:18am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef INSTRUMENTATION_H_INCLUDED
+#define INSTRUMENTATION_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "SIMD.h"
+#if SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#elif SIMD_X86
+#include <x86intrin.h>
+#endif
+
+#ifndef SMODELS_INSTRUMENTATION
+#define SMODELS_INSTRUMENTATION 1 //0 compiles the recording out, local() always returns nullptr
+#endif
+#define INSTRUMENTATIONSLOTS 16 //threads that get a slot to themselves, any more share the last one
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  Hot path instrumentation
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//per stage tick counts plus a handful of model counters, recorded from the audio thread and the analysis
+//workers. every thread writes to its own cache line aligned slot with relaxed atomics, so recording never
+//allocates, locks or does i/o. snapshot() can be called from any other thread to sum them up
+namespace instrumentation{
+    enum class STAGE{CAPTURE, FFT, SPECTRUM, DETECT, MATCH, BIRTH, RESIDUAL, UPDATE, RENDER, NUMSTAGES};
+    //ACTIVETRACKS is summed once per hop (divide by DETECT calls for the mean), MAXACTIVETRACKS is a high water mark
+    enum class COUNTER{PEAKS, SIDELOBES, BORN, KILLED, STOLEN, ACTIVETRACKS, MAXACTIVETRACKS, DROPPEDHOPS, DROPPEDFRAMES,
+                       RENDEREDSAMPLES, NUMCOUNTERS};
+    const int numStages = (int)STAGE::NUMSTAGES, numCounters = (int)COUNTER::NUMCOUNTERS;
+
+    //cheapest monotonic clock we can get: the TSC on x86, the virtual counter on ARM64, nanoseconds otherwise
+    inline uint64_t ticks(){
+#if SIMD_X86
+        return __rdtsc();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+        uint64_t t;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+        return t;
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct alignas(SIMD_ALIGNMENT) Slot{
+        std::atomic<size_t> owner;//hashed id of the thread that claimed it, 0 while free
+        std::atomic<uint64_t> stageTicks[numStages], calls[numStages], maxTicks[numStages], counters[numCounters];
+
+        void record(const STAGE s, const uint64_t t){
+            int i = (int)s;
+            stageTicks[i].fetch_add(t, std::memory_order_relaxed);
+            calls[i].fetch_add(1, std::memory_order_relaxed);
+            if(t > maxTicks[i].load(std::memory_order_relaxed)){//only the shared overflow slot can lose a race here
+                maxTicks[i].store(t, std::memory_order_relaxed);
+            }
+        }
+        void add(const COUNTER c, const uint64_t n){
+            counters[(int)c].fetch_add(n, std::memory_order_relaxed);
+        }
+        void max(const COUNTER c, const uint64_t n){
+            if(n > counters[(int)c].load(std::memory_order_relaxed)){
+                counters[(int)c].store(n, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct Snapshot{
+        uint64_t stageTicks[numStages], calls[numStages], maxTicks[numStages], counters[numCounters];
+        int numThreads;//threads that have recorded anything
+        double ticksPerSecond;
+
+        double getSeconds(const STAGE s) const{return stageTicks[(int)s] / ticksPerSecond;}
+        double getMeanMicroseconds(const STAGE s) const{
+            return (calls[(int)s] > 0)?1e6 * stageTicks[(int)s] / (ticksPerSecond * calls[(int)s]):0.0;
+        }
+        double getMaxMicroseconds(const STAGE s) const{return 1e6 * maxTicks[(int)s] / ticksPerSecond;}
+    };
+
+    Slot * local();//the calling thread's slot, claimed on first use. nullptr while recording is disabled
+    void snapshot(Snapshot &s);//sum over every slot, safe from any thread
+    void reset();//zero everything, counts recorded while this runs may be lost
+    void setEnabled(const bool e);
+    bool isEnabled();
+    double getTicksPerSecond();//calibrated on first call, so make that from a non audio thread (snapshot() does)
+    const char * getName(const STAGE s);
+    const char * getName(const COUNTER c);
+
+    inline void count(Slot * slot, const COUNTER c, const uint64_t n = 1){
+        if(slot != nullptr){
+            slot->add(c, n);
+        }
+    }
+
+    //times the enclosing scope into slot, does nothing if slot is nullptr
+    class ScopedTimer{
+    private:
+        Slot * slot;
+        STAGE stage;
+        uint64_t start;
+    public:
+        ScopedTimer(Slot * s, const STAGE st) : slot(s), stage(st), start((s != nullptr)?ticks():0){}
+        ~ScopedTimer(){
+            if(slot != nullptr){
+                slot->record(stage, ticks() - start);
+            }
+        }
+    };
+}
+
+#endif  // INSTRUMENTATION_H_INCLUDED
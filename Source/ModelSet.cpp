@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+    ModelSet.cpp
+    Created: 17 Oct 2026 5:20:57am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "ModelSet.h"
+#include "AnalysisPool.h"
+
+//////////////////////////////////////////////////////////////
+//  ModelSet
+//////////////////////////////////////////////////////////////
+ModelSet::ModelSet(const ModelConfig &c, const int n, const float sr, AnalysisPool * pool){
+    config = c;
+    numModels = n;
+    models = new SinusoidalModel*[numModels];
+    for(int i = 0; i < numModels; ++i){
+        models[i] = new SinusoidalModel(config.window, config.windowSize, config.hopFactor, sr, config.padded,
+                                        Wavetable<float>::WAVEFORM::SINE, 2048, config.resolutions);
+        models[i]->setPrecision(Analysis::PRECISION::FAST);
+        models[i]->getSynthesis().setSeed(NOISEDEFAULTSEED + i);//so the channels' residuals aren't identical
+        if(pool != nullptr){
+            models[i]->setAnalysisPool(pool);
+        }
+        models[i]->init();
+    }
+}
+
+ModelSet::~ModelSet(){
+    for(int i = 0; i < numModels; ++i){
+        delete models[i];//waits for, and gives back, its pool slot
+    }
+    delete[] models;
+}
+
+void ModelSet::init(){
+    for(int i = 0; i < numModels; ++i){
+        models[i]->init();
+    }
+}
+
+//////////////////////////////////////////////////////////////
+//  ModelBuilder
+//////////////////////////////////////////////////////////////
+const int ModelBuilder::windowSizes[] = {512, 1024, 2048, 4096};
+const int ModelBuilder::numWindowSizes = 4;
+const int ModelBuilder::hopFactors[] = {2, 4, 8};
+const int ModelBuilder::numHopFactors = 3;
+
+ModelBuilder::ModelBuilder(const ModelConfig &current, const int nc, const float sr, AnalysisPool * p){
+    numChannels = nc;
+    samplingRate = sr;
+    pool = p;
+    active = current;
+    outstanding = deferred = nullptr;
+    preplan = false;
+    for(int i = 0; i < MODELSETCACHE; ++i){
+        cache[i] = nullptr;
+    }
+    requested.store(current.pack());
+    ready.store(nullptr);
+    retired.store(nullptr);
+    pinned.store(nullptr);
+    running.store(false);
+}
+
+ModelBuilder::~ModelBuilder(){
+    ModelSet * s;
+    if(running.exchange(false)){
+        wake.notify_all();
+        thread.join();
+    }
+    //a set the audio thread has taken belongs to it now, anything still offered or handed back is ours
+    if((s = ready.exchange(nullptr)) != nullptr){
+        delete s;
+    }
+    if((s = retired.exchange(nullptr)) != nullptr){
+        delete s;
+    }
+    for(int i = 0; i < MODELSETCACHE; ++i){
+        delete cache[i];
+    }
+    delete deferred;
+}
+
+void ModelBuilder::start(const bool plan){
+    preplan = plan;
+    running.store(true);
+    thread = std::thread(&ModelBuilder::run, this);
+}
+
+void ModelBuilder::request(const ModelConfig &c){
+    requested.store(c.pack());
+    wake.notify_one();
+}
+
+ModelSet * ModelBuilder::take(){
+    return ready.exchange(nullptr);
+}
+
+void ModelBuilder::retire(ModelSet * s){
+    retired.store(s);
+    wake.notify_one();
+}
+
+//the usual hazard pointer handshake: once current still holds what we pinned, it can't have been retired
+//before the pin was visible, so discard() is bound to see it
+ModelSet * ModelBuilder::pin(const std::atomic<ModelSet *> &current){
+    ModelSet * s;
+    do{
+        s = current.load();
+        pinned.store(s);
+    }while(s != current.load());
+    return s;
+}
+
+void ModelBuilder::unpin(){
+    pinned.store(nullptr);
+    wake.notify_one();
+}
+
+void ModelBuilder::discard(ModelSet * s){
+    if(s != nullptr && s == pinned.load()){
+        delete deferred;//only one set is pinned at a time, so the last one we held back is free
+        deferred = s;
+    }
+    else{
+        delete s;
+    }
+}
+
+void ModelBuilder::stash(ModelSet * s){
+    discard(cache[MODELSETCACHE - 1]);
+    for(int i = MODELSETCACHE - 1; i > 0; --i){
+        cache[i] = cache[i - 1];
+    }
+    cache[0] = s;
+}
+
+ModelSet * ModelBuilder::reuse(const ModelConfig &c){
+    ModelSet * s;
+    for(int i = 0; i < MODELSETCACHE; ++i){
+        if(cache[i] != nullptr && cache[i]->getConfig() == c){
+            s = cache[i];
+            for(; i < MODELSETCACHE - 1; ++i){
+                cache[i] = cache[i + 1];
+            }
+            cache[MODELSETCACHE - 1] = nullptr;
+            s->init();
+            return s;
+        }
+    }
+    return nullptr;
+}
+
+void ModelBuilder::serve(){
+    ModelSet * s = retired.exchange(nullptr);
+    ModelConfig want = ModelConfig::unpack(requested.load());
+    if(deferred != nullptr && deferred != pinned.load()){
+        delete deferred;
+        deferred = nullptr;
+    }
+    if(s != nullptr){//the audio thread swapped in what we offered
+        active = outstanding->getConfig();
+        outstanding = nullptr;
+        stash(s);
+    }
+    if(outstanding != nullptr){
+        if(outstanding->getConfig() == want){
+            return;
+        }
+        if((s = ready.exchange(nullptr)) == nullptr){//already taken, wait for the retire
+            return;
+        }
+        outstanding = nullptr;//not taken yet and out of date, take it back
+        stash(s);
+    }
+    if(want == active){
+        return;
+    }
+    if((s = reuse(want)) == nullptr){
+        s = new ModelSet(want, numChannels, samplingRate, pool);
+    }
+    outstanding = s;
+    ready.store(s);
+}
+
+void ModelBuilder::run(){
+    ModelConfig c;
+    int i, j, k;
+    if(preplan){
+        //the shared plans outlive the models that made them (see FFTPlans.h), so building each configuration once
+        //up front makes later builds of the same sizes quick. requests still get served in between
+        for(i = 0; i < numWindowSizes; ++i){
+            for(j = 0; j < numHopFactors; ++j){
+                for(k = 0; k < 2 && running.load(); ++k){
+                    serve();
+                    c.windowSize = windowSizes[i];
+                    c.hopFactor = hopFactors[j];
+                    c.padded = (k == 1);
+                    //plans only depend on the sizes, so whatever window and resolutions the active set has, its
+                    //sizes are already planned. the decimated bass window transforms at our size anyway
+                    if(c.windowSize != active.windowSize || c.hopFactor != active.hopFactor || c.padded != active.padded){
+                        delete new SinusoidalModel(windows::TYPE::GAUSSIAN, c.windowSize, c.hopFactor, samplingRate, c.padded,
+                                                   Wavetable<float>::WAVEFORM::SINE, 2048);
+                    }
+                }
+            }
+        }
+    }
+    while(running.load()){
+        serve();
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
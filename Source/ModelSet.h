@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    ModelSet.h
+    Created: 17 Oct 2026 5:20:57am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef MODELSET_H_INCLUDED
+#define MODELSET_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "SinusoidalModel.h"
+
+#define MODELSETCACHE 2 //retired sets kept around, so flipping back to a recent configuration is instant
+
+class AnalysisPool;
+
+//////////////////////////////////////////////////////////////
+//  ModelConfig (the analysis settings a model is built with)
+//////////////////////////////////////////////////////////////
+struct ModelConfig{
+    int windowSize, hopFactor, resolutions;//see SinusoidalModel for resolutions
+    windows::TYPE window;
+    bool padded;
+
+    //packed so a request fits in one lock free atomic
+    uint32_t pack() const{
+        return (uint32_t)windowSize | ((uint32_t)hopFactor << 16) | ((uint32_t)resolutions << 24) | ((uint32_t)window << 26) |
+        ((padded)?0x80000000u:0u);
+    }
+    static ModelConfig unpack(const uint32_t p){
+        ModelConfig c;
+        c.windowSize = p & 0xFFFF;
+        c.hopFactor = (p >> 16) & 0xFF;
+        c.resolutions = (p >> 24) & 0x3;
+        c.window = (windows::TYPE)((p >> 26) & 0xF);
+        c.padded = (p & 0x80000000u) != 0;
+        return c;
+    }
+    bool operator==(const ModelConfig &c) const{return pack() == c.pack();}
+    bool operator!=(const ModelConfig &c) const{return pack() != c.pack();}
+};
+
+//////////////////////////////////////////////////////////////
+//  ModelSet (one model per channel, all with the same config)
+//////////////////////////////////////////////////////////////
+class ModelSet{
+private:
+    SinusoidalModel ** models;
+    ModelConfig config;
+    int numModels;
+public:
+    //not realtime safe, allocates and runs the FFTW planner. pool may be nullptr
+    ModelSet(const ModelConfig &c, const int n, const float sr, AnalysisPool * pool);
+    ~ModelSet();
+
+    //getters
+    SinusoidalModel * getModel(const int i) const{return models[i];}
+    int getNumModels() const{return numModels;}
+    const ModelConfig & getConfig() const{return config;}
+
+    void init();//reset every model, not realtime safe
+};
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  ModelBuilder Class (builds replacement ModelSets off the audio thread)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//request() can be called from anywhere, including the audio thread. the builder thread picks the request
+//up, takes the set from its cache or builds a new one, and leaves it in a single slot for the audio
+//thread to take() at its next hop boundary. the set that was swapped out comes back through retire(), so
+//allocation, planning and deletion all happen on the builder thread. only one set is ever in flight each
+//way: nothing new is offered until the last swap's retired set has been picked up. a reader off the audio
+//thread (the editor) pins the set it's reading, and one that falls out of the cache meanwhile waits for unpin()
+class ModelBuilder{
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> running;
+    std::atomic<uint32_t> requested;
+    std::atomic<ModelSet *> ready, retired, pinned;
+    //builder thread only
+    ModelSet * cache[MODELSETCACHE];//most recent first
+    ModelSet * outstanding;//offered to the audio thread and not retired yet
+    ModelSet * deferred;//fell out of the cache while it was pinned
+    ModelConfig active;//what the audio thread is running, as far as we know
+    AnalysisPool * pool;
+    float samplingRate;
+    int numChannels;
+    bool preplan;
+
+    void run();
+    void serve();//one pass: collect what was retired, offer what was requested
+    void stash(ModelSet * s);//into the cache, deleting whatever falls off the end
+    void discard(ModelSet * s);//delete it, or defer it while it's pinned
+    ModelSet * reuse(const ModelConfig &c);//out of the cache, or nullptr
+public:
+    ModelBuilder(const ModelConfig &current, const int nc, const float sr, AnalysisPool * p);
+    ~ModelBuilder();//joins the thread and deletes every set it still holds
+
+    //plan, once each, every combination of the sizes below before settling down, so the shared plans all exist already
+    void start(const bool plan = true);
+
+    void request(const ModelConfig &c);//lock free, takes effect at the next hop boundary after it's built
+    ModelSet * take();//audio thread, the set to swap in or nullptr. swap it in and retire the old one in the same callback
+    void retire(ModelSet * s);//audio thread, hands the swapped out set back. only after a successful take()
+
+    //one reader at a time, never the audio thread. the set in current stays valid until unpin(), swapped out or not
+    ModelSet * pin(const std::atomic<ModelSet *> &current);
+    void unpin();
+
+    //what the host parameters can choose from
+    static const int windowSizes[], numWindowSizes, hopFactors[], numHopFactors;
+};
+
+#endif  // MODELSET_H_INCLUDED
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    Noise.cpp
+    Created: 17 Oct 2026 6:05:00am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "Noise.h"
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define NOISEUNIT (1.0f / 8388608.0f) //2^-23: the top 24 bits of a draw, as [0, 2)
+
+static uint64_t splitmix64(uint64_t &x){//the seeding xoshiro's authors recommend
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline int trailingZeros(const uint32_t x){//x can't be 0
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, x);
+    return (int)i;
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+WhiteNoise::WhiteNoise(const uint64_t s, const simd::ISA cap){
+    state = (uint32_t *)simd::alignedAlloc(sizeof(uint32_t) * 4 * NOISELANES);
+    isa = simd::detect(cap);
+    switch(isa){
+#if SIMD_HAS_AVX2
+        case simd::ISA::AVX2:
+            kernel = &WhiteNoise::fillAVX2;
+            break;
+#endif
+#if SIMD_X86
+        case simd::ISA::SSE2:
+            kernel = &WhiteNoise::fillSSE2;
+            break;
+#endif
+#if SIMD_NEON
+        case simd::ISA::NEON:
+            kernel = &WhiteNoise::fillNEON;
+            break;
+#endif
+        default:
+            kernel = &WhiteNoise::fillScalar;
+            break;
+    }
+    seed(s);
+}
+
+WhiteNoise::~WhiteNoise(){
+    simd::alignedFree(state);
+}
+
+void WhiteNoise::seed(const uint64_t s){
+    uint64_t x = s, r;
+    for(int lane = 0; lane < NOISELANES; ++lane){
+        for(int w = 0; w < 4; w += 2){
+            r = splitmix64(x);
+            state[w * NOISELANES + lane] = (uint32_t)r;
+            state[(w + 1) * NOISELANES + lane] = (uint32_t)(r >> 32);
+        }
+        if((state[lane] | state[NOISELANES + lane] | state[2 * NOISELANES + lane] | state[3 * NOISELANES + lane]) == 0){
+            state[lane] = 1;//all zero is the one state xoshiro never leaves
+        }
+    }
+    numSpare = 0;
+}
+
+void WhiteNoise::fill(float * out, const int n){
+    int i = 0, numSteps;
+    while(i < n && numSpare > 0){
+        out[i++] = spare[NOISELANES - numSpare--];
+    }
+    numSteps = (n - i) / NOISELANES;
+    if(numSteps > 0){
+        kernel(state, out + i, numSteps);
+        i += numSteps * NOISELANES;
+    }
+    if(i < n){//part of a step left over, keep the rest for next time
+        kernel(state, spare, 1);
+        numSpare = NOISELANES;
+        while(i < n){
+            out[i++] = spare[NOISELANES - numSpare--];
+        }
+    }
+}
+
+float WhiteNoise::next(){
+    if(numSpare == 0){
+        kernel(state, spare, 1);
+        numSpare = NOISELANES;
+    }
+    return spare[NOISELANES - numSpare--];
+}
+
+//////////////////////////////////////////////////////////////
+//  Kernels
+//////////////////////////////////////////////////////////////
+//xoshiro128+ on every lane: result = s0 + s3, then the xor/shift/rotate state update
+
+void WhiteNoise::fillScalar(uint32_t * state, float * out, const int numSteps){
+    uint32_t s0, s1, s2, s3, t, r;
+    for(int step = 0; step < numSteps; ++step){
+        for(int lane = 0; lane < NOISELANES; ++lane){
+            s0 = state[lane];
+            s1 = state[NOISELANES + lane];
+            s2 = state[2 * NOISELANES + lane];
+            s3 = state[3 * NOISELANES + lane];
+            r = s0 + s3;
+            t = s1 << 9;
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = (s3 << 11) | (s3 >> 21);
+            state[lane] = s0;
+            state[NOISELANES + lane] = s1;
+            state[2 * NOISELANES + lane] = s2;
+            state[3 * NOISELANES + lane] = s3;
+            out[step * NOISELANES + lane] = (float)(r >> 8) * NOISEUNIT - 1.0f;
+        }
+    }
+}
+
+#if SIMD_X86
+void WhiteNoise::fillSSE2(uint32_t * state, float * out, const int numSteps){
+    const __m128 unit = _mm_set1_ps(NOISEUNIT), one = _mm_set1_ps(1.0f);
+    __m128i s0, s1, s2, s3, t, r;
+    for(int half = 0; half < NOISELANES; half += 4){//two independent groups of four lanes
+        s0 = _mm_load_si128((const __m128i *)(state + half));
+        s1 = _mm_load_si128((const __m128i *)(state + NOISELANES + half));
+        s2 = _mm_load_si128((const __m128i *)(state + 2 * NOISELANES + half));
+        s3 = _mm_load_si128((const __m128i *)(state + 3 * NOISELANES + half));
+        for(int step = 0; step < numSteps; ++step){
+            r = _mm_add_epi32(s0, s3);
+            t = _mm_slli_epi32(s1, 9);
+            s2 = _mm_xor_si128(s2, s0);
+            s3 = _mm_xor_si128(s3, s1);
+            s1 = _mm_xor_si128(s1, s2);
+            s0 = _mm_xor_si128(s0, s3);
+            s2 = _mm_xor_si128(s2, t);
+            s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+            //r >> 8 fits in 24 bits, so the signed conversion is exact
+            _mm_storeu_ps(out + step * NOISELANES + half, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(r, 8)), unit), one));
+        }
+        _mm_store_si128((__m128i *)(state + half), s0);
+        _mm_store_si128((__m128i *)(state + NOISELANES + half), s1);
+        _mm_store_si128((__m128i *)(state + 2 * NOISELANES + half), s2);
+        _mm_store_si128((__m128i *)(state + 3 * NOISELANES + half), s3);
+    }
+}
+#endif
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX2 void WhiteNoise::fillAVX2(uint32_t * state, float * out, const int numSteps){
+    const __m256 unit = _mm256_set1_ps(NOISEUNIT), one = _mm256_set1_ps(1.0f);
+    __m256i s0, s1, s2, s3, t, r;
+    s0 = _mm256_load_si256((const __m256i *)state);
+    s1 = _mm256_load_si256((const __m256i *)(state + NOISELANES));
+    s2 = _mm256_load_si256((const __m256i *)(state + 2 * NOISELANES));
+    s3 = _mm256_load_si256((const __m256i *)(state + 3 * NOISELANES));
+    for(int step = 0; step < numSteps; ++step){
+        r = _mm256_add_epi32(s0, s3);
+        t = _mm256_slli_epi32(s1, 9);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi32(s3, 11), _mm256_srli_epi32(s3, 21));
+        //no fma here, it would round differently from the other kernels
+        _mm256_storeu_ps(out + step * NOISELANES, _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(r, 8)), unit), one));
+    }
+    _mm256_store_si256((__m256i *)state, s0);
+    _mm256_store_si256((__m256i *)(state + NOISELANES), s1);
+    _mm256_store_si256((__m256i *)(state + 2 * NOISELANES), s2);
+    _mm256_store_si256((__m256i *)(state + 3 * NOISELANES), s3);
+}
+#endif
+
+#if SIMD_NEON
+void WhiteNoise::fillNEON(uint32_t * state, float * out, const int numSteps){
+    const float32x4_t unit = vdupq_n_f32(NOISEUNIT), one = vdupq_n_f32(1.0f);
+    uint32x4_t s0, s1, s2, s3, t, r;
+    for(int half = 0; half < NOISELANES; half += 4){
+        s0 = vld1q_u32(state + half);
+        s1 = vld1q_u32(state + NOISELANES + half);
+        s2 = vld1q_u32(state + 2 * NOISELANES + half);
+        s3 = vld1q_u32(state + 3 * NOISELANES + half);
+        for(int step = 0; step < numSteps; ++step){
+            r = vaddq_u32(s0, s3);
+            t = vshlq_n_u32(s1, 9);
+            s2 = veorq_u32(s2, s0);
+            s3 = veorq_u32(s3, s1);
+            s1 = veorq_u32(s1, s2);
+            s0 = veorq_u32(s0, s3);
+            s2 = veorq_u32(s2, t);
+            s3 = vorrq_u32(vshlq_n_u32(s3, 11), vshrq_n_u32(s3, 21));
+            vst1q_f32(out + step * NOISELANES + half, vsubq_f32(vmulq_f32(vcvtq_f32_u32(vshrq_n_u32(r, 8)), unit), one));
+        }
+        vst1q_u32(state + half, s0);
+        vst1q_u32(state + NOISELANES + half, s1);
+        vst1q_u32(state + 2 * NOISELANES + half, s2);
+        vst1q_u32(state + 3 * NOISELANES + half, s3);
+    }
+}
+#endif
+
+//////////////////////////////////////////////////////////////
+//  PinkNoise
+//////////////////////////////////////////////////////////////
+
+PinkNoise::PinkNoise(const uint64_t s, const simd::ISA cap) : white(s, cap){
+    seed(s);
+}
+
+void PinkNoise::seed(const uint64_t s){
+    white.seed(s);
+    white.fill(rows, PINKROWS);
+    sum = 0.0f;
+    for(int k = 0; k < PINKROWS; ++k){
+        sum += rows[k];
+    }
+    counter = 0;
+}
+
+void PinkNoise::fill(float * out, const int n){
+    const float scale = 1.0f / (PINKROWS + 1);
+    int i, j, k, count;
+    for(i = 0; i < n; i += count){
+        count = std::min(n - i, PINKBLOCK);
+        white.fill(block, 2 * count);//a row's new value and the white one, per sample
+        for(j = 0; j < count; ++j){
+            counter++;
+            k = trailingZeros(counter | (1u << (PINKROWS - 1)));//row 0 every other sample, row 1 every 4th...
+            sum += block[2 * j] - rows[k];
+            rows[k] = block[2 * j];
+            out[i + j] = (sum + block[2 * j + 1]) * scale;
+            if((counter & (PINKBLOCK - 1)) == 0){//start the running sum over now and then, so rounding can't build up
+                sum = 0.0f;
+                for(k = 0; k < PINKROWS; ++k){
+                    sum += rows[k];
+                }
+            }
+        }
+    }
+}
+
+float PinkNoise::next(){
+    float out;
+    fill(&out, 1);
+    return out;
+}
@@ -11,67 +11,80 @@
 #ifndef NOISE_H_INCLUDED
 #define NOISE_H_INCLUDED
 
-#include <ctime>
-#include <random>//C++11
-#include <cassert>
+#include <cstdint>
+#include "SIMD.h"
 
-//sample-and-hold 6 octave pink noise generator based on algorithm described here: http://www.firstpr.com.au/dsp/pink-noise/
-//<random> usage adapted from example here: http://choorucode.com/2010/11/24/c-random-number-generation-using-random/
-template <class T>
-class PinkNoise{
+#define NOISELANES 8 //independent xoshiro128+ streams, interleaved one sample each
+#define NOISEDEFAULTSEED 0x736D6F64656C73ull
+#define PINKROWS 16 //octaves of Voss-McCartney, the lowest updates every 2^15 samples
+#define PINKBLOCK 256 //samples of pink noise per pass over the white generator
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  WhiteNoise Class (block xoshiro128+)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//NOISELANES xoshiro128+ generators kept side by side, so one step is a single vector operation on AVX2 (two on
+//SSE2/NEON). lane i's output goes to sample i of every NOISELANES, whatever the instruction set, and the
+//int to float conversion is exact, so a given seed produces the same samples on every machine and for any
+//split into blocks. no allocation after construction
+class WhiteNoise{
+public:
+    typedef void (*Kernel)(uint32_t * state, float * out, const int numSteps);
 private:
-    typedef std::minstd_rand                               Engine;
-    typedef std::uniform_real_distribution<T>        Distribution;//might not work for ints?
-    typedef std::default_random_engine                  Generator;
-    const int octaves;
-    int * counters, * timers;
-    Generator * generator;
-    T * values;
+    uint32_t * state;//4 words x NOISELANES, word major
+    float spare[NOISELANES];//what's left of the last step when a fill doesn't end on a multiple of NOISELANES
+    int numSpare;
+    simd::ISA isa;
+    Kernel kernel;
+
+    static void fillScalar(uint32_t * state, float * out, const int numSteps);
+#if SIMD_X86
+    static void fillSSE2(uint32_t * state, float * out, const int numSteps);
+#endif
+#if SIMD_HAS_AVX2
+    static void fillAVX2(uint32_t * state, float * out, const int numSteps);
+#endif
+#if SIMD_NEON
+    static void fillNEON(uint32_t * state, float * out, const int numSteps);
+#endif
 public:
-    PinkNoise(){
-        values = nullptr;
-        counters = nullptr;
-        timers = nullptr;
-        generator = nullptr;
-    }
-    ~PinkNoise(){
-        delete[] values;
-        delete[] counters;
-        delete[] timers;
-        delete generator;
-    }
-    T getRandom(){
-        return (T)(*generator)();
-    }
-    void init(const T min, const T max){
-        generator = new Generator(Engine(time(0)), Distribution(min, max));
-        octaves = 6;//0th octave is full-on white noise
-        values = new T[octaves];
-        counters = new int[octaves];
-        timers = new int[octaves];
-        for(int i = 0; i < octaves; ++i){
-            values[i] = getRandom();//initialize all octaves with random values
-            timers[i] = pow(2, i);//establish sampling delays
-            counters[i] = (i<=1)?0:timers[i-1] + 1;//stagger initializations so exactly 2 numbers are generated at each step
-        }
-    }
-    T next(){
-        T out = 0;
-        int numUpdates = 0;
-        for(int i = 0; i < octaves; ++i){
-            out += values[i] / octaves;
-            counters[i]++;
-            if(counters[i] == timers[i]){
-                counters[i] = 0;
-                values[i] = getRandom();
-                numUpdates++;
-            }
-        }
-        assert(numUpdates == 2);//for testing
-        return out;
-    }
+    WhiteNoise(const uint64_t s = NOISEDEFAULTSEED, const simd::ISA cap = simd::ISA::AVX2);
+    ~WhiteNoise();
+
+    //getters
+    simd::ISA getISA() const{return isa;}
+
+    //setters
+    void seed(const uint64_t s);//restarts the sequence, realtime safe
+
+    void fill(float * out, const int n);//uniform in [-1, 1)
+    float next();//one sample of the same sequence fill() produces
 };
 
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  PinkNoise Class (Voss-McCartney)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//PINKROWS white values, row k redrawn every 2^(k + 1) samples, plus a fresh white value every sample. rows are
+//staggered by the trailing zeros of a sample counter, so exactly one row changes per sample and the sum
+//is kept running instead of re-added. see http://www.firstpr.com.au/dsp/pink-noise/
+//random numbers come from a WhiteNoise a block at a time. output is in [-1, 1)
+class PinkNoise{
+private:
+    WhiteNoise white;
+    float rows[PINKROWS], block[2 * PINKBLOCK];
+    float sum;
+    uint32_t counter;
+public:
+    PinkNoise(const uint64_t s = NOISEDEFAULTSEED, const simd::ISA cap = simd::ISA::AVX2);
+
+    //setters
+    void seed(const uint64_t s);
 
+    void fill(float * out, const int n);
+    float next();
+};
 
 #endif  // NOISE_H_INCLUDED
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    NoiseSynthesis.cpp
+    Created: 17 Oct 2026 6:00:15am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "NoiseSynthesis.h"
+#include "FFTPlans.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+NoiseSynthesis::NoiseSynthesis(const float sr, const int hop){
+    int i, b, numCentres, ringSize;
+    float f, nyquist = sr * 0.5f, centres[RESIDUALBANDS];
+    hopSize = hop;
+    fftSize = 2 * hopSize;
+    numBins = fftSize / 2 + 1;
+    numReady = 0;
+    std::fill(levels, levels + RESIDUALBANDS, 0.0f);
+    //a bin with magnitude a (and its conjugate) is a sinusoid of amplitude 2a, variance 2a^2, spread over sr / fftSize Hz
+    binScale = sqrtf(sr / (2.0f * fftSize));
+
+    //bands that start past nyquist never get a level, so they don't get a centre either
+    for(numCentres = 0; numCentres < RESIDUALBANDS && residual::edges[numCentres] < nyquist; ++numCentres){
+        centres[numCentres] = residual::getCentre(numCentres, nyquist);
+    }
+    lowerBand = new int[numBins];
+    upperWeight = new float[numBins];
+    for(i = 0, b = 0; i < numBins; ++i){
+        f = i * sr / fftSize;
+        while(b + 1 < numCentres && centres[b + 1] <= f){
+            b++;
+        }
+        lowerBand[i] = b;
+        upperWeight[i] = (b + 1 < numCentres && f > centres[b])?(f - centres[b]) / (centres[b + 1] - centres[b]):0.0f;
+    }
+    window = new float[fftSize];
+    for(i = 0; i < fftSize; ++i){
+        window[i] = sinf(M_PI * (i + 0.5f) / fftSize);
+    }
+    grain = new float[fftSize];
+    phases = new float[numBins];
+    for(ringSize = 1; ringSize < fftSize; ringSize <<= 1){
+        ;
+    }
+    outputBuffer = new RingBuffer<float>(ringSize);
+
+    realBuffer = (float*) fftwf_malloc(sizeof(float) * fftSize);
+    complexBuffer = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * numBins);
+    backwardPlan = fftplans::acquire(fftSize, fftplans::DIRECTION::BACKWARD, realBuffer, complexBuffer);
+    memset(realBuffer, 0, sizeof(float) * fftSize);
+    memset(complexBuffer, 0, sizeof(fftwf_complex) * numBins);
+}
+
+NoiseSynthesis::~NoiseSynthesis(){
+    delete[] lowerBand;
+    delete[] upperWeight;
+    delete[] window;
+    delete[] grain;
+    delete[] phases;
+    delete outputBuffer;
+    fftplans::release(backwardPlan);
+    fftwf_free(realBuffer);
+    fftwf_free(complexBuffer);
+}
+
+void NoiseSynthesis::setLevels(const float * l, const float scale){
+    for(int b = 0; b < RESIDUALBANDS; ++b){
+        levels[b] = l[b] * scale;
+    }
+}
+
+void NoiseSynthesis::synthesizeGrain(){
+    int i, b;
+    float a, phase;
+    memset(complexBuffer, 0, sizeof(fftwf_complex) * numBins);
+    white.fill(phases, numBins);//drawn for every bin, silent or not, so a seed gives the same noise whatever the levels
+    for(i = 1; i < numBins - 1; ++i){//no dc, and nyquist would need a real value
+        b = lowerBand[i];
+        a = levels[b];
+        if(upperWeight[i] > 0.0f){
+            a += upperWeight[i] * (levels[b + 1] - a);
+        }
+        if(a > 0.0f){
+            a *= binScale;
+            phase = M_PI * phases[i];
+            complexBuffer[i][0] = a * cosf(phase);
+            complexBuffer[i][1] = a * sinf(phase);
+        }
+    }
+    fftwf_execute_dft_c2r(backwardPlan, complexBuffer, realBuffer);
+    for(i = 0; i < fftSize; ++i){
+        grain[i] = realBuffer[i] * window[i];
+    }
+    outputBuffer->add(grain, fftSize, hopSize);
+    numReady += hopSize;
+}
+
+void NoiseSynthesis::render(float * out, const int n, const float gain){
+    int j, count;
+    for(int i = 0; i < n; i += count){
+        if(numReady == 0){
+            synthesizeGrain();
+        }
+        count = std::min(std::min(numReady, n - i), fftSize);
+        outputBuffer->take(grain, count);//grain is free again until the next synthesizeGrain()
+        for(j = 0; j < count; ++j){
+            out[i + j] += gain * grain[j];
+        }
+        numReady -= count;
+    }
+}
+
+void NoiseSynthesis::reset(){
+    outputBuffer->clear();
+    numReady = 0;
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    NoiseSynthesis.h
+    Created: 17 Oct 2026 6:00:15am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef NOISESYNTHESIS_H_INCLUDED
+#define NOISESYNTHESIS_H_INCLUDED
+
+#include <fftw3.h>
+#include "Noise.h"
+#include "Residual.h"
+#include "RingBuffer.h"
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  NoiseSynthesis Class (residual resynthesis by inverse FFT)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//turns the band levels a Frame carries back into noise: each grain is a spectrum with the band envelope
+//(interpolated between band centres) for magnitudes and random phases, inverse FFT'd, and overlap-added a
+//hop apart under a sine window. sin^2 + cos^2 = 1, so uncorrelated grains sum to constant power.
+//same grain-at-a-time rendering as SpectralSynthesis, nothing allocates or locks after construction
+class NoiseSynthesis{
+private:
+    float levels[RESIDUALBANDS];//the latest frame's, already scaled to output
+    int * lowerBand;//per bin, the band centre at or below it. RESIDUALBANDS - 1 past the last centre
+    float * upperWeight;//per bin, how far it is towards the next band centre
+    float * window;//sine, fftSize points
+    float * realBuffer, * grain;
+    fftwf_complex * complexBuffer;
+    fftwf_plan backwardPlan;
+    RingBuffer<float> * outputBuffer;
+    WhiteNoise white;
+    float * phases;//one draw per bin, per grain
+    float binScale;//band density to bin magnitude
+    int hopSize, fftSize, numBins, numReady;
+
+    void synthesizeGrain();
+public:
+    NoiseSynthesis(const float sr, const int hop);
+    ~NoiseSynthesis();
+
+    //setters
+    void setLevels(const float * l, const float scale);//RESIDUALBANDS densities, used from the next grain
+    void seed(const uint64_t s){white.seed(s);}//same seed, same noise. give each channel its own
+
+    //adds the noise * gain to out, synthesizing grains as they're needed
+    void render(float * out, const int n, const float gain);
+    void reset();//drop anything already overlap-added
+};
+
+#endif  // NOISESYNTHESIS_H_INCLUDED
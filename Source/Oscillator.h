@@ -23,13 +23,17 @@
 //00001111111111111111111111111111
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 
 template <class T>
 class Oscillator;
+class OscillatorBank;
 
 template <class T>
 class Wavetable {
 friend class Oscillator<T>;
+friend class OscillatorBank;
 public:
     enum class WAVEFORM{SINE};
 private:
@@ -123,7 +127,6 @@ public:
         //update phase, wrap
         phase += increment;
         phase &= PHASEMASK;
-        //TODO: look into time-frequency reassignment
         return out * currentAmplitude;
     }
     void update(const T a, const T f, const T p, const int i){
@@ -0,0 +1,378 @@
+/*
+  ==============================================================================
+
+    OscillatorBank.cpp
+    Created: 17 Oct 2026 4:29:56am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "OscillatorBank.h"
+#include <cstring>
+#include <algorithm>
+
+OscillatorBank::OscillatorBank(){
+    block = nullptr;
+    wavetable = nullptr;
+    size = capacity = limit = 0;
+    width = 1;
+    isa = simd::ISA::SCALAR;
+    kernel = &OscillatorBank::renderScalar;
+}
+OscillatorBank::~OscillatorBank(){
+    simd::alignedFree(block);
+    wavetable = nullptr;
+}
+
+void OscillatorBank::init(Wavetable<float> * wt, const float sr, const int n, const simd::ISA cap){
+    uint32_t sizeTest, loMod;
+    int stride;
+    float * base;
+    samplingRate = sr;
+    wavetable = wt;
+    for(sizeTest = wavetable->size, loBits = 0; (sizeTest & MAXTABLESIZE) == 0; loBits++, sizeTest <<= 1){
+        ;
+    }
+    assert(sizeTest == MAXTABLESIZE);//makes sure wavetable size is a power of two
+    loMod = MAXTABLESIZE / wavetable->size;
+    loMask = loMod - 1;
+    loDivide = 1.0 / (float)loMod;
+    samplingInterval = MAXTABLESIZE / samplingRate;
+    interpDivide = 1.0 / (float)MAXTABLESIZE;
+
+    isa = simd::detect(cap);
+    width = simd::lanes(isa);
+    switch(isa){
+#if SIMD_HAS_AVX2
+        case simd::ISA::AVX2:
+            kernel = &OscillatorBank::renderAVX2;
+            break;
+#endif
+#if SIMD_X86
+        case simd::ISA::SSE2:
+            kernel = &OscillatorBank::renderSSE2;
+            break;
+#endif
+#if SIMD_NEON
+        case simd::ISA::NEON:
+            kernel = &OscillatorBank::renderNEON;
+            break;
+#endif
+        default:
+            kernel = &OscillatorBank::renderScalar;
+            break;
+    }
+
+    //one block for everything, each array starting on its own cache line
+    size = n;
+    capacity = simd::roundUp(n, SIMD_MAXLANES);
+    stride = simd::roundUp(capacity, SIMD_ALIGNMENT / sizeof(float));
+    simd::alignedFree(block);
+    block = simd::alignedAlloc(sizeof(float) * (stride * 11 + BANKCHUNK * SIMD_MAXLANES));
+    memset(block, 0, sizeof(float) * (stride * 11 + BANKCHUNK * SIMD_MAXLANES));
+    base = (float *)block;
+    phase = (uint32_t *)base;
+    interpPhase = (uint32_t *)(base + stride);
+    interpInc = (uint32_t *)(base + stride * 2);
+    active = (uint32_t *)(base + stride * 3);
+    amplitude = base + stride * 4;
+    targetAmplitude = base + stride * 5;
+    currentAmplitude = base + stride * 6;
+    frequency = base + stride * 7;
+    targetFrequency = base + stride * 8;
+    currentFrequency = base + stride * 9;
+    gain = base + stride * 10;
+    lanes = base + stride * 11;
+    limit = 0;
+}
+
+void OscillatorBank::start(const int i, const float a, const float f, const float /*p*/){//phases aren't tracked, as in Oscillator
+    phase[i] = 0;
+    interpPhase[i] = 0;
+    interpInc[i] = 0;
+    amplitude[i] = currentAmplitude[i] = targetAmplitude[i] = a;
+    frequency[i] = currentFrequency[i] = targetFrequency[i] = f;
+}
+
+void OscillatorBank::update(const int i, const float a, const float f, const float /*p*/, const int d){
+    assert(a >= 0.0 && a <= 1.0);
+    interpPhase[i] = 0;
+    interpInc[i] = MAXTABLESIZE / d;
+    //ramp from wherever the last rendered sample left off
+    amplitude[i] = currentAmplitude[i];
+    targetAmplitude[i] = a;
+    frequency[i] = currentFrequency[i];
+    targetFrequency[i] = f;
+}
+
+void OscillatorBank::stop(const int i){
+    amplitude[i] = currentAmplitude[i] = targetAmplitude[i] = 0;
+}
+
+void OscillatorBank::settle(){
+    for(int i = 0; i < size; ++i){
+        amplitude[i] = currentAmplitude[i] = targetAmplitude[i];
+        frequency[i] = currentFrequency[i] = targetFrequency[i];
+        interpPhase[i] = interpInc[i] = 0;
+    }
+}
+
+void OscillatorBank::setActive(const int i, const bool a){
+    active[i] = a?0xFFFFFFFF:0;
+    if(a){
+        if(i >= limit){
+            limit = i + 1;
+        }
+    }
+    else if(i == limit - 1){//shrink the range we have to walk
+        while(limit > 0 && active[limit - 1] == 0){
+            limit--;
+        }
+    }
+}
+
+void OscillatorBank::render(float * out, const int n){
+    if(limit == 0){
+        memset(out, 0, sizeof(float) * n);
+        return;
+    }
+    kernel(*this, out, n);
+}
+
+//////////////////////////////////////////////////////////////
+//  Kernels
+//////////////////////////////////////////////////////////////
+//all kernels follow Oscillator<float>::next(): read the table at the current phase, compute the ramped
+//amplitude/frequency for this sample, then advance the interpolation and table phases.
+
+void OscillatorBank::renderScalar(OscillatorBank &bank, float * out, const int n){
+    const float * table = bank.wavetable->data;
+    uint32_t ph, ip, inc, readPos;
+    float interpFraction, oneMinusInterpFraction, fraction, sample, amp, frq, g;
+    int i, s;
+    memset(out, 0, sizeof(float) * n);
+    for(i = 0; i < bank.limit; ++i){
+        if(!bank.active[i]){
+            continue;
+        }
+        ph = bank.phase[i];
+        ip = bank.interpPhase[i];
+        inc = bank.interpInc[i];
+        g = bank.gain[i];
+        amp = bank.currentAmplitude[i];
+        frq = bank.currentFrequency[i];
+        for(s = 0; s < n; ++s){
+            interpFraction = ip * bank.interpDivide;
+            oneMinusInterpFraction = 1.0f - interpFraction;
+            fraction = (ph & bank.loMask) * bank.loDivide;
+            readPos = ph >> bank.loBits;
+            sample = (1.0f - fraction) * table[readPos] + fraction * table[readPos + 1];
+            amp = oneMinusInterpFraction * bank.amplitude[i] + interpFraction * bank.targetAmplitude[i];
+            frq = oneMinusInterpFraction * bank.frequency[i] + interpFraction * bank.targetFrequency[i];
+            ip = (ip + inc) & PHASEMASK;
+            ph = (ph + (uint32_t)(frq * bank.samplingInterval)) & PHASEMASK;
+            out[s] += sample * amp * g;
+        }
+        bank.phase[i] = ph;
+        bank.interpPhase[i] = ip;
+        bank.currentAmplitude[i] = amp;
+        bank.currentFrequency[i] = frq;
+    }
+}
+
+#if SIMD_X86
+void OscillatorBank::renderSSE2(OscillatorBank &bank, float * out, const int n){
+    const float * table = bank.wavetable->data;
+    const __m128i phaseMask = _mm_set1_epi32(PHASEMASK), loMask = _mm_set1_epi32(bank.loMask),
+    loBits = _mm_cvtsi32_si128(bank.loBits);
+    const __m128 one = _mm_set1_ps(1.0f), interpDivide = _mm_set1_ps(bank.interpDivide),
+    loDivide = _mm_set1_ps(bank.loDivide), samplingInterval = _mm_set1_ps(bank.samplingInterval);
+    __m128 * acc = (__m128 *)bank.lanes;
+    __m128i act, ph, ip, inc, readPos;
+    __m128 actf, a0, a1, f0, f1, g, amp, frq, interpFraction, oneMinusInterpFraction, fraction, lo, hi, sum;
+    alignas(16) int32_t idx[4];
+    int offset, m, i, s;
+    for(offset = 0; offset < n; offset += BANKCHUNK){
+        m = std::min(BANKCHUNK, n - offset);
+        for(s = 0; s < m; ++s){
+            acc[s] = _mm_setzero_ps();
+        }
+        for(i = 0; i < bank.limit; i += 4){
+            act = _mm_load_si128((const __m128i *)(bank.active + i));
+            if(_mm_movemask_epi8(act) == 0){//whole vector is idle
+                continue;
+            }
+            actf = _mm_castsi128_ps(act);
+            ph = _mm_load_si128((const __m128i *)(bank.phase + i));
+            ip = _mm_load_si128((const __m128i *)(bank.interpPhase + i));
+            inc = _mm_and_si128(_mm_load_si128((const __m128i *)(bank.interpInc + i)), act);
+            a0 = _mm_load_ps(bank.amplitude + i);
+            a1 = _mm_load_ps(bank.targetAmplitude + i);
+            f0 = _mm_load_ps(bank.frequency + i);
+            f1 = _mm_load_ps(bank.targetFrequency + i);
+            g = _mm_and_ps(_mm_load_ps(bank.gain + i), actf);
+            amp = frq = _mm_setzero_ps();
+            for(s = 0; s < m; ++s){
+                interpFraction = _mm_mul_ps(_mm_cvtepi32_ps(ip), interpDivide);
+                oneMinusInterpFraction = _mm_sub_ps(one, interpFraction);
+                fraction = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(ph, loMask)), loDivide);
+                readPos = _mm_srl_epi32(ph, loBits);
+                _mm_store_si128((__m128i *)idx, readPos);
+                lo = _mm_set_ps(table[idx[3]], table[idx[2]], table[idx[1]], table[idx[0]]);
+                hi = _mm_set_ps(table[idx[3] + 1], table[idx[2] + 1], table[idx[1] + 1], table[idx[0] + 1]);
+                lo = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, fraction), lo), _mm_mul_ps(fraction, hi));
+                amp = _mm_add_ps(_mm_mul_ps(oneMinusInterpFraction, a0), _mm_mul_ps(interpFraction, a1));
+                frq = _mm_add_ps(_mm_mul_ps(oneMinusInterpFraction, f0), _mm_mul_ps(interpFraction, f1));
+                ip = _mm_and_si128(_mm_add_epi32(ip, inc), phaseMask);
+                ph = _mm_and_si128(_mm_add_epi32(ph, _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(frq, samplingInterval)), act)), phaseMask);
+                acc[s] = _mm_add_ps(acc[s], _mm_mul_ps(_mm_mul_ps(lo, amp), g));
+            }
+            _mm_store_si128((__m128i *)(bank.phase + i), ph);
+            _mm_store_si128((__m128i *)(bank.interpPhase + i), ip);
+            _mm_store_ps(bank.currentAmplitude + i, _mm_or_ps(_mm_and_ps(actf, amp), _mm_andnot_ps(actf, _mm_load_ps(bank.currentAmplitude + i))));
+            _mm_store_ps(bank.currentFrequency + i, _mm_or_ps(_mm_and_ps(actf, frq), _mm_andnot_ps(actf, _mm_load_ps(bank.currentFrequency + i))));
+        }
+        for(s = 0; s < m; ++s){//horizontal sums
+            sum = _mm_add_ps(acc[s], _mm_movehl_ps(acc[s], acc[s]));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            out[offset + s] = _mm_cvtss_f32(sum);
+        }
+    }
+}
+#endif
+
+#if SIMD_HAS_AVX2
+SIMD_TARGET_AVX2
+void OscillatorBank::renderAVX2(OscillatorBank &bank, float * out, const int n){
+    const float * table = bank.wavetable->data;
+    const __m256i phaseMask = _mm256_set1_epi32(PHASEMASK), loMask = _mm256_set1_epi32(bank.loMask),
+    loBits = _mm256_set1_epi32(bank.loBits);
+    const __m256 interpDivide = _mm256_set1_ps(bank.interpDivide), loDivide = _mm256_set1_ps(bank.loDivide),
+    samplingInterval = _mm256_set1_ps(bank.samplingInterval), one = _mm256_set1_ps(1.0f);
+    __m256 * acc = (__m256 *)bank.lanes;
+    __m256i act, ph, ip, inc, readPos;
+    __m256 actf, a0, a1, f0, f1, g, amp, frq, interpFraction, fraction, lo, hi;
+    __m128 sum;
+    int offset, m, i, s;
+    for(offset = 0; offset < n; offset += BANKCHUNK){
+        m = std::min(BANKCHUNK, n - offset);
+        for(s = 0; s < m; ++s){
+            acc[s] = _mm256_setzero_ps();
+        }
+        for(i = 0; i < bank.limit; i += 8){
+            act = _mm256_load_si256((const __m256i *)(bank.active + i));
+            if(_mm256_testz_si256(act, act)){//whole vector is idle
+                continue;
+            }
+            actf = _mm256_castsi256_ps(act);
+            ph = _mm256_load_si256((const __m256i *)(bank.phase + i));
+            ip = _mm256_load_si256((const __m256i *)(bank.interpPhase + i));
+            inc = _mm256_and_si256(_mm256_load_si256((const __m256i *)(bank.interpInc + i)), act);
+            a0 = _mm256_load_ps(bank.amplitude + i);
+            a1 = _mm256_load_ps(bank.targetAmplitude + i);
+            f0 = _mm256_load_ps(bank.frequency + i);
+            f1 = _mm256_load_ps(bank.targetFrequency + i);
+            g = _mm256_and_ps(_mm256_load_ps(bank.gain + i), actf);
+            amp = frq = _mm256_setzero_ps();
+            for(s = 0; s < m; ++s){
+                interpFraction = _mm256_mul_ps(_mm256_cvtepi32_ps(ip), interpDivide);
+                fraction = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(ph, loMask)), loDivide);
+                readPos = _mm256_srlv_epi32(ph, loBits);
+                lo = _mm256_i32gather_ps(table, readPos, 4);
+                hi = _mm256_i32gather_ps(table + 1, readPos, 4);
+                lo = _mm256_fmadd_ps(_mm256_sub_ps(one, fraction), lo, _mm256_mul_ps(fraction, hi));
+                amp = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, interpFraction), a0), _mm256_mul_ps(interpFraction, a1));
+                //no fma here: the phase increment is truncated from this, so keep the rounding identical to Oscillator
+                frq = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, interpFraction), f0), _mm256_mul_ps(interpFraction, f1));
+                ip = _mm256_and_si256(_mm256_add_epi32(ip, inc), phaseMask);
+                ph = _mm256_and_si256(_mm256_add_epi32(ph, _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(frq, samplingInterval)), act)), phaseMask);
+                acc[s] = _mm256_fmadd_ps(_mm256_mul_ps(lo, amp), g, acc[s]);
+            }
+            _mm256_store_si256((__m256i *)(bank.phase + i), ph);
+            _mm256_store_si256((__m256i *)(bank.interpPhase + i), ip);
+            _mm256_store_ps(bank.currentAmplitude + i, _mm256_blendv_ps(_mm256_load_ps(bank.currentAmplitude + i), amp, actf));
+            _mm256_store_ps(bank.currentFrequency + i, _mm256_blendv_ps(_mm256_load_ps(bank.currentFrequency + i), frq, actf));
+        }
+        for(s = 0; s < m; ++s){//horizontal sums
+            sum = _mm_add_ps(_mm256_castps256_ps128(acc[s]), _mm256_extractf128_ps(acc[s], 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            out[offset + s] = _mm_cvtss_f32(sum);
+        }
+    }
+}
+#endif
+
+#if SIMD_NEON
+static inline bool anyLane(const uint32x4_t v){
+    uint32x2_t folded = vorr_u32(vget_low_u32(v), vget_high_u32(v));
+    return (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) != 0;
+}
+static inline float sumLanes(const float32x4_t v){
+    float32x2_t folded = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(folded, folded), 0);
+}
+
+void OscillatorBank::renderNEON(OscillatorBank &bank, float * out, const int n){
+    const float * table = bank.wavetable->data;
+    const uint32x4_t phaseMask = vdupq_n_u32(PHASEMASK), loMask = vdupq_n_u32(bank.loMask);
+    const int32x4_t loBits = vdupq_n_s32(-(int32_t)bank.loBits);//negative shift = shift right
+    const float32x4_t one = vdupq_n_f32(1.0f), interpDivide = vdupq_n_f32(bank.interpDivide),
+    loDivide = vdupq_n_f32(bank.loDivide), samplingInterval = vdupq_n_f32(bank.samplingInterval);
+    float32x4_t * acc = (float32x4_t *)bank.lanes;
+    uint32x4_t act, ph, ip, inc, readPos;
+    float32x4_t a0, a1, f0, f1, g, amp, frq, interpFraction, oneMinusInterpFraction, fraction, lo, hi;
+    uint32_t idx[4];
+    int offset, m, i, s;
+    for(offset = 0; offset < n; offset += BANKCHUNK){
+        m = std::min(BANKCHUNK, n - offset);
+        for(s = 0; s < m; ++s){
+            acc[s] = vdupq_n_f32(0.0f);
+        }
+        for(i = 0; i < bank.limit; i += 4){
+            act = vld1q_u32(bank.active + i);
+            if(!anyLane(act)){//whole vector is idle
+                continue;
+            }
+            ph = vld1q_u32(bank.phase + i);
+            ip = vld1q_u32(bank.interpPhase + i);
+            inc = vandq_u32(vld1q_u32(bank.interpInc + i), act);
+            a0 = vld1q_f32(bank.amplitude + i);
+            a1 = vld1q_f32(bank.targetAmplitude + i);
+            f0 = vld1q_f32(bank.frequency + i);
+            f1 = vld1q_f32(bank.targetFrequency + i);
+            g = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vld1q_f32(bank.gain + i)), act));
+            amp = frq = vdupq_n_f32(0.0f);
+            for(s = 0; s < m; ++s){
+                interpFraction = vmulq_f32(vcvtq_f32_u32(ip), interpDivide);
+                oneMinusInterpFraction = vsubq_f32(one, interpFraction);
+                fraction = vmulq_f32(vcvtq_f32_u32(vandq_u32(ph, loMask)), loDivide);
+                readPos = vshlq_u32(ph, loBits);
+                vst1q_u32(idx, readPos);
+                lo = vsetq_lane_f32(table[idx[0]], vdupq_n_f32(0.0f), 0);
+                lo = vsetq_lane_f32(table[idx[1]], lo, 1);
+                lo = vsetq_lane_f32(table[idx[2]], lo, 2);
+                lo = vsetq_lane_f32(table[idx[3]], lo, 3);
+                hi = vsetq_lane_f32(table[idx[0] + 1], vdupq_n_f32(0.0f), 0);
+                hi = vsetq_lane_f32(table[idx[1] + 1], hi, 1);
+                hi = vsetq_lane_f32(table[idx[2] + 1], hi, 2);
+                hi = vsetq_lane_f32(table[idx[3] + 1], hi, 3);
+                lo = vmlaq_f32(vmulq_f32(fraction, hi), vsubq_f32(one, fraction), lo);
+                amp = vmlaq_f32(vmulq_f32(interpFraction, a1), oneMinusInterpFraction, a0);
+                frq = vmlaq_f32(vmulq_f32(interpFraction, f1), oneMinusInterpFraction, f0);
+                ip = vandq_u32(vaddq_u32(ip, inc), phaseMask);
+                ph = vandq_u32(vaddq_u32(ph, vandq_u32(vcvtq_u32_f32(vmulq_f32(frq, samplingInterval)), act)), phaseMask);
+                acc[s] = vmlaq_f32(acc[s], vmulq_f32(lo, amp), g);
+            }
+            vst1q_u32(bank.phase + i, ph);
+            vst1q_u32(bank.interpPhase + i, ip);
+            vst1q_f32(bank.currentAmplitude + i, vbslq_f32(act, amp, vld1q_f32(bank.currentAmplitude + i)));
+            vst1q_f32(bank.currentFrequency + i, vbslq_f32(act, frq, vld1q_f32(bank.currentFrequency + i)));
+        }
+        for(s = 0; s < m; ++s){
+            out[offset + s] = sumLanes(acc[s]);
+        }
+    }
+}
+#endif
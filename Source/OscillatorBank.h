@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    OscillatorBank.h
+    Created: 17 Oct 2026 4:29:56am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef OSCILLATORBANK_H_INCLUDED
+#define OSCILLATORBANK_H_INCLUDED
+
+#include "Oscillator.h"
+#include "SIMD.h"
+
+//number of samples rendered per pass over the bank; bounds the size of the per-lane accumulator
+#define BANKCHUNK 64
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  OscillatorBank Class (structure-of-arrays Oscillator<float>)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//same wavetable lookup and amplitude/frequency ramping as Oscillator<float>::next(), but the state for
+//every partial lives in contiguous aligned arrays so a whole block can be rendered for all of them at once.
+//slot i corresponds to track i in the model. inactive slots are frozen and skipped a whole vector at a time.
+class OscillatorBank{
+public:
+    typedef void (*Kernel)(OscillatorBank &bank, float * out, const int n);
+private:
+    uint32_t * phase, * interpPhase, * interpInc, * active;
+    float * amplitude, * targetAmplitude, * currentAmplitude, * frequency, * targetFrequency, * currentFrequency, * gain;
+    float * lanes;//BANKCHUNK x SIMD_MAXLANES accumulator, one partial sum per lane per sample
+    void * block;
+    Wavetable<float> * wavetable;
+    uint32_t loBits, loMask;
+    float samplingRate, samplingInterval, loDivide, interpDivide;
+    int size, capacity, limit, width;
+    simd::ISA isa;
+    Kernel kernel;
+
+    static void renderScalar(OscillatorBank &bank, float * out, const int n);
+#if SIMD_X86
+    static void renderSSE2(OscillatorBank &bank, float * out, const int n);
+#endif
+#if SIMD_HAS_AVX2
+    static void renderAVX2(OscillatorBank &bank, float * out, const int n);
+#endif
+#if SIMD_NEON
+    static void renderNEON(OscillatorBank &bank, float * out, const int n);
+#endif
+public:
+    OscillatorBank();
+    ~OscillatorBank();
+
+    void init(Wavetable<float> * wt, const float sr, const int n, const simd::ISA cap = simd::ISA::AVX2);
+
+    //same semantics as Oscillator<float>::start/update/stop, addressed by slot
+    void start(const int i, const float a, const float f, const float p);
+    void update(const int i, const float a, const float f, const float p, const int d);
+    void stop(const int i);
+    void settle();//every slot jumps to the end of its ramp, for when render() hasn't been keeping up with the updates
+
+    //getters
+    int getSize() const{return size;}
+    simd::ISA getISA() const{return isa;}
+    float getAmplitude(const int i) const{return currentAmplitude[i];}
+    float getFrequency(const int i) const{return currentFrequency[i];}
+
+    //setters
+    void setActive(const int i, const bool a);
+    void setGain(const int i, const float g){gain[i] = g;}
+
+    //overwrites out with the sum of every active slot's output * gain
+    void render(float * out, const int n);
+};
+
+#endif  // OSCILLATORBANK_H_INCLUDED
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    PartialFile.h
+    Created: 17 Oct 2026 5:50:54am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef PARTIALFILE_H_INCLUDED
+#define PARTIALFILE_H_INCLUDED
+
+#include <cstdint>
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  SMPF (smodels partial file) layout
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//every Frame a model produced, stored so it can be mapped and fed straight back into a SynthesisEngine.
+//little endian throughout, every section starts on an 8 byte boundary.
+//
+//  header                  PartialFileHeader
+//  chunk 0 .. n-1          up to PARTIALCHUNKFRAMES frames each, as columns:
+//                            frame columns    index, hopSize, activeTracks (int32), denormFactor (float),
+//                                             firstPartial, numPartials (uint32, relative to the chunk)
+//                            partial columns  track (int32), amp, frq, phs, gain (float), event, status (uint8)
+//  chunk table             PartialFileChunk for each chunk
+//  trailer                 PartialFileTrailer, always the last 24 bytes
+//
+//chunks are written as they fill, the table and trailer on close, so a file that was never closed has
+//no trailer and is rejected rather than misread
+#define PARTIALFILEMAGIC 0x46504D53u //"SMPF"
+#define PARTIALFILEEND 0x45504D53u //"SMPE"
+#define PARTIALFILEVERSION 1
+#define PARTIALCHUNKFRAMES 256
+
+struct PartialFileHeader{
+    uint32_t magic, version;
+    float samplingRate;
+    int32_t windowSize, hopSize, maxTracks;//hopSize is nominal, every frame carries its own
+    uint32_t reserved[2];
+};
+
+struct PartialFileChunk{
+    uint64_t offset;//of the chunk's first column, from the start of the file
+    uint32_t numFrames, numPartials;
+};
+
+struct PartialFileTrailer{
+    uint64_t tableOffset;
+    uint32_t numChunks, numFrames;
+    uint32_t end, reserved;
+};
+
+//byte offsets of each column within a chunk, from its numFrames and numPartials
+struct PartialFileColumns{
+    uint64_t index, hopSize, activeTracks, denormFactor, firstPartial, numPartials;
+    uint64_t track, amp, frq, phs, gain, event, status, size;
+
+    PartialFileColumns(const uint32_t f, const uint32_t p){
+        uint64_t frameColumn = align(4 * (uint64_t)f), partialColumn = align(4 * (uint64_t)p), byteColumn = align(p);
+        index = 0;
+        hopSize = index + frameColumn;
+        activeTracks = hopSize + frameColumn;
+        denormFactor = activeTracks + frameColumn;
+        firstPartial = denormFactor + frameColumn;
+        numPartials = firstPartial + frameColumn;
+        track = numPartials + frameColumn;
+        amp = track + partialColumn;
+        frq = amp + partialColumn;
+        phs = frq + partialColumn;
+        gain = phs + partialColumn;
+        event = gain + partialColumn;
+        status = event + byteColumn;
+        size = status + byteColumn;
+    }
+    static uint64_t align(const uint64_t n){return (n + 7) & ~(uint64_t)7;}
+};
+
+#endif  // PARTIALFILE_H_INCLUDED
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    PartialPlayer.cpp
+    Created: 17 Oct 2026 5:54:38am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "PartialPlayer.h"
+#include <algorithm>
+#include <cmath>
+
+PartialPlayer::PartialPlayer(const PartialReader &r, Wavetable<float>::WAVEFORM wf, const int wts){
+    reader = &r;
+    wavetable = new Wavetable<float>(wf, wts);
+    synthesis = new SynthesisEngine(wavetable, reader->getSamplingRate(), reader->getMaxTracks(), reader->getHopSize());
+    frame = new Frame(reader->getMaxTracks());
+    lead = new Frame(reader->getMaxTracks());
+    stretch = 1.0;
+    carry = 0.0;
+    position = samplesUntilFrame = 0;
+    restart = true;//the file may have been recorded from a model that was already running
+}
+
+PartialPlayer::~PartialPlayer(){
+    delete synthesis;
+    delete wavetable;
+    delete frame;
+    delete lead;
+}
+
+void PartialPlayer::setStretch(const float s){
+    stretch = std::max(s, 0.01f);
+}
+
+void PartialPlayer::seek(const int k){
+    synthesis->reset();
+    position = std::min(std::max(k, 0), reader->getNumFrames());
+    samplesUntilFrame = 0;
+    carry = 0.0;
+    restart = true;
+}
+
+void PartialPlayer::seekTime(const double seconds){
+    double hops = (seconds * reader->getSamplingRate() - reader->getWindowSize() / 2) / reader->getHopSize();
+    seek(reader->find((int)std::ceil(std::max(hops, 0.0))));
+}
+
+void PartialPlayer::next(){
+    float d;
+    int k, n;
+    if(!reader->read(position, *frame)){//only if the file is corrupt past the header, stop rather than play garbage
+        synthesis->reset();
+        position = reader->getNumFrames();
+        samplesUntilFrame = 0;
+        return;
+    }
+    d = frame->hopSize * stretch + carry;
+    n = std::max((int)d, 1);
+    carry = d - n;
+    frame->hopSize = n;
+    if(restart){//start everything already sounding at 0 and let this frame ramp it up
+        lead->numPartials = 0;
+        lead->hopSize = n;
+        lead->activeTracks = frame->activeTracks;
+        lead->index = frame->index;
+        lead->denormFactor = frame->denormFactor;
+        for(k = 0; k < frame->numPartials; ++k){
+            Frame::Partial &partial = frame->partials[k];
+            if(partial.isActive() && partial.event != Frame::EVENT::START){
+                lead->add(partial.track, Frame::EVENT::START, partial.status, 0.0, partial.frq, partial.phs, partial.gain);
+                partial.event = Frame::EVENT::UPDATE;
+            }
+        }
+        if(lead->numPartials > 0){
+            synthesis->apply(*lead);
+        }
+        restart = false;
+    }
+    synthesis->apply(*frame);
+    position++;
+    samplesUntilFrame = n;
+}
+
+int PartialPlayer::process(float * out, const int numSamples){
+    int segment, numApplied = 0;
+    for(int i = 0; i < numSamples; i += segment){
+        if(samplesUntilFrame == 0){
+            if(position < reader->getNumFrames()){
+                next();
+                numApplied++;
+            }
+            else{//the last frame has had its hop
+                if(synthesis->getNumActive() > 0){
+                    synthesis->reset();
+                }
+                synthesis->render(out + i, numSamples - i);
+                break;
+            }
+        }
+        segment = std::min(samplesUntilFrame, numSamples - i);
+        synthesis->render(out + i, segment);
+        samplesUntilFrame -= segment;
+    }
+    return numApplied;
+}
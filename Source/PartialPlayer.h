@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    PartialPlayer.h
+    Created: 17 Oct 2026 5:54:38am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef PARTIALPLAYER_H_INCLUDED
+#define PARTIALPLAYER_H_INCLUDED
+
+#include "Oscillator.h"
+#include "PartialReader.h"
+#include "SynthesisEngine.h"
+#include "Track.h"
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  PartialPlayer Class (resynthesis from a partial file)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//the synthesis half of SinusoidalModel::process() with the analysis swapped for a PartialReader: at each
+//hop boundary the next frame is read out of the mapped file and applied, so playing back only costs
+//oscillator time.
+//
+//time stretch only changes how many samples each frame lasts (the ramp length Oscillator::update gets),
+//frequencies are untouched, so pitch is kept. the oscillator bank only: SpectralSynthesis lays its grains a
+//fixed hop apart and ignores the ramp length, so the frames would drift against the output. seeking silences everything and fades the partials that are
+//sounding at the new position in over one hop, instead of ramping them from wherever we were
+class PartialPlayer{
+private:
+    const PartialReader * reader;
+    SynthesisEngine * synthesis;
+    Wavetable<float> * wavetable;
+    Frame * frame, * lead;//lead: fades the partials in after a seek
+    float stretch, carry;//carry: fraction of a sample the stretched hops have accumulated
+    int position, samplesUntilFrame;//position: next frame to apply
+    bool restart;
+
+    void next();//apply the frame at position and schedule the one after it
+public:
+    //r has to be open and outlive the player. not realtime safe
+    PartialPlayer(const PartialReader &r, Wavetable<float>::WAVEFORM wf, const int wts);
+    ~PartialPlayer();
+
+    //getters
+    int getPosition() const{return position;}
+    float getStretch() const{return stretch;}
+    bool isFinished() const{return position >= reader->getNumFrames() && samplesUntilFrame == 0;}
+    SynthesisEngine & getSynthesis(){return *synthesis;}
+
+    //setters, realtime safe but only from the thread that calls process()
+    void setStretch(const float s);//output duration / original duration, takes effect from the next frame
+    void seek(const int k);//to the k-th frame in the file
+    void seekTime(const double seconds);//to the first frame centred at or after seconds into the original
+
+    int process(float * out, const int numSamples);//overwrites out, returns # of frames applied. silent once finished
+};
+
+#endif  // PARTIALPLAYER_H_INCLUDED
@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    PartialReader.cpp
+    Created: 17 Oct 2026 5:54:38am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "PartialReader.h"
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//every column starts on an 8 byte boundary, so they can be used in place
+template <typename T>
+static const T * column(const unsigned char * chunk, const uint64_t offset){
+    return (const T *)(chunk + offset);
+}
+
+PartialReader::PartialReader(){
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    table = nullptr;
+    trailer = nullptr;
+#ifdef _WIN32
+    file = mapping = nullptr;
+#endif
+}
+
+PartialReader::~PartialReader(){
+    close();
+}
+
+bool PartialReader::open(const std::string &path){
+    close();
+    if(!map(path)){
+        std::cout << "Error: couldn't map " << path << std::endl;
+        return false;
+    }
+    if(size < sizeof(PartialFileHeader) + sizeof(PartialFileTrailer)){
+        std::cout << "Error: " << path << " is too short to be an SMPF file" << std::endl;
+        close();
+        return false;
+    }
+    header = (const PartialFileHeader *)data;
+    trailer = (const PartialFileTrailer *)(data + size - sizeof(PartialFileTrailer));
+    if(!validate()){
+        std::cout << "Error: " << path << " isn't a complete SMPF version " << PARTIALFILEVERSION << " file" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PartialReader::close(){
+    unmap();
+    header = nullptr;
+    table = nullptr;
+    trailer = nullptr;
+}
+
+bool PartialReader::map(const std::string &path){
+#ifdef _WIN32
+    LARGE_INTEGER length;
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE){
+        file = nullptr;
+        return false;
+    }
+    if(!GetFileSizeEx(file, &length) || length.QuadPart == 0 ||
+       (mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) == nullptr){
+        unmap();
+        return false;
+    }
+    data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    size = (size_t)length.QuadPart;
+#else
+    struct stat info;
+    void * p;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        return false;
+    }
+    if(fstat(fd, &info) != 0 || info.st_size == 0){
+        ::close(fd);
+        return false;
+    }
+    p = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);//the mapping keeps the file alive
+    if(p == MAP_FAILED){
+        return false;
+    }
+    data = (const unsigned char *)p;
+    size = (size_t)info.st_size;
+#endif
+    if(data == nullptr){
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+void PartialReader::unmap(){
+#ifdef _WIN32
+    if(data != nullptr){
+        UnmapViewOfFile(data);
+    }
+    if(mapping != nullptr){
+        CloseHandle(mapping);
+    }
+    if(file != nullptr){
+        CloseHandle(file);
+    }
+    file = mapping = nullptr;
+#else
+    if(data != nullptr){
+        munmap((void *)data, size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool PartialReader::validate(){
+    uint64_t end = size - sizeof(PartialFileTrailer), total = 0;
+    uint32_t k;
+    if(header->magic != PARTIALFILEMAGIC || header->version != PARTIALFILEVERSION || trailer->end != PARTIALFILEEND ||
+       !(header->samplingRate > 0.0) || header->windowSize <= 0 || header->hopSize <= 0 || header->maxTracks <= 0){
+        return false;
+    }
+    if(trailer->tableOffset % 8 != 0 || trailer->tableOffset < sizeof(PartialFileHeader) ||
+       trailer->tableOffset > end || (end - trailer->tableOffset) / sizeof(PartialFileChunk) < trailer->numChunks){
+        return false;
+    }
+    table = (const PartialFileChunk *)(data + trailer->tableOffset);
+    for(k = 0; k < trailer->numChunks; ++k){
+        const PartialFileChunk &chunk = table[k];
+        //read() finds a frame's chunk by dividing, so every chunk but the last has to be full
+        if(chunk.numFrames == 0 || chunk.numFrames > PARTIALCHUNKFRAMES ||
+           (k + 1 < trailer->numChunks && chunk.numFrames != PARTIALCHUNKFRAMES)){
+            return false;
+        }
+        if(chunk.offset % 8 != 0 || chunk.offset < sizeof(PartialFileHeader) || chunk.offset > trailer->tableOffset ||
+           PartialFileColumns(chunk.numFrames, chunk.numPartials).size > trailer->tableOffset - chunk.offset){
+            return false;
+        }
+        total += chunk.numFrames;
+    }
+    return total == trailer->numFrames;
+}
+
+int PartialReader::getIndex(const int k) const{
+    const PartialFileChunk &chunk = table[k / PARTIALCHUNKFRAMES];
+    PartialFileColumns c(chunk.numFrames, chunk.numPartials);
+    return column<int32_t>(data + chunk.offset, c.index)[k % PARTIALCHUNKFRAMES];
+}
+
+double PartialReader::getTime(const int k) const{//same convention as the SDIF times PartialWriter writes
+    return (header->windowSize / 2 + (double)getIndex(k) * header->hopSize) / header->samplingRate;
+}
+
+int PartialReader::find(const int index) const{
+    int lo = 0, hi = getNumFrames(), mid;
+    while(lo < hi){//indices only ever increase, gaps are where frames were dropped
+        mid = lo + (hi - lo) / 2;
+        if(getIndex(mid) < index){
+            lo = mid + 1;
+        }
+        else{
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool PartialReader::read(const int k, Frame &f) const{
+    uint32_t first, n, i;
+    int j;
+    uint8_t e, s;
+    if(k < 0 || k >= getNumFrames()){
+        return false;
+    }
+    const PartialFileChunk &chunk = table[k / PARTIALCHUNKFRAMES];
+    const unsigned char * base = data + chunk.offset;
+    PartialFileColumns c(chunk.numFrames, chunk.numPartials);
+    int row = k % PARTIALCHUNKFRAMES;
+    first = column<uint32_t>(base, c.firstPartial)[row];
+    n = column<uint32_t>(base, c.numPartials)[row];
+    if(first > chunk.numPartials || n > chunk.numPartials - first){
+        return false;
+    }
+    f.index = column<int32_t>(base, c.index)[row];
+    f.hopSize = column<int32_t>(base, c.hopSize)[row];
+    f.activeTracks = column<int32_t>(base, c.activeTracks)[row];
+    f.denormFactor = column<float>(base, c.denormFactor)[row];
+    f.numPartials = 0;
+    if(f.hopSize <= 0){
+        return false;
+    }
+    if(n > (uint32_t)f.capacity){//same as Frame::copy, whatever doesn't fit is dropped
+        n = (uint32_t)f.capacity;
+    }
+    for(i = first; i < first + n; ++i){
+        j = column<int32_t>(base, c.track)[i];
+        e = column<uint8_t>(base, c.event)[i];
+        s = column<uint8_t>(base, c.status)[i];
+        if(j < 0 || j >= header->maxTracks || e > (uint8_t)Frame::EVENT::UPDATE || s > (uint8_t)TrackStore::STATUS::DEAD){
+            f.numPartials = 0;
+            return false;
+        }
+        f.add(j, (Frame::EVENT)e, (TrackStore::STATUS)s, column<float>(base, c.amp)[i], column<float>(base, c.frq)[i],
+              column<float>(base, c.phs)[i], column<float>(base, c.gain)[i]);
+    }
+    return true;
+}
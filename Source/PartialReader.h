@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    PartialReader.h
+    Created: 17 Oct 2026 5:54:38am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef PARTIALREADER_H_INCLUDED
+#define PARTIALREADER_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include "PartialFile.h"
+#include "Track.h"
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  PartialReader Class (memory mapped SMPF file)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//maps a file PartialWriter wrote and reads frames straight out of its columns. open() only checks the
+//header, chunk table and trailer, nothing is parsed or copied up front, so opening is instant whatever the
+//size and the OS pages in whatever gets played. read() doesn't allocate or lock, so once the file is open
+//it is safe to call from the audio callback (page faults aside)
+class PartialReader{
+private:
+    const unsigned char * data;
+    size_t size;
+    const PartialFileHeader * header;
+    const PartialFileChunk * table;
+    const PartialFileTrailer * trailer;
+#ifdef _WIN32
+    void * file, * mapping;
+#endif
+
+    bool map(const std::string &path);
+    void unmap();
+    bool validate();//also points table at the chunk table
+public:
+    PartialReader();
+    ~PartialReader();
+
+    //not realtime safe. false if the file can't be mapped or isn't a complete SMPF file
+    bool open(const std::string &path);
+    void close();
+
+    //getters
+    bool isOpen() const{return data != nullptr;}
+    float getSamplingRate() const{return header->samplingRate;}
+    int getWindowSize() const{return header->windowSize;}
+    int getHopSize() const{return header->hopSize;}//nominal, frames carry their own
+    int getMaxTracks() const{return header->maxTracks;}
+    int getNumFrames() const{return (int)trailer->numFrames;}
+    int getIndex(const int k) const;//hop index of the k-th frame in the file
+    double getTime(const int k) const;//centre of the k-th frame's analysis window, in seconds
+    int find(const int index) const;//first frame at or after hop index, getNumFrames() if there isn't one
+
+    bool read(const int k, Frame &f) const;//overwrites f with the k-th frame. false if k is out of range or corrupt
+};
+
+#endif  // PARTIALREADER_H_INCLUDED
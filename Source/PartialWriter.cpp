@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    PartialWriter.cpp
+    Created: 17 Oct 2026 5:50:54am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "PartialWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+//SDIF is big endian, SMPF is whatever we are (little endian everywhere we build)
+static void putBig(std::vector<unsigned char> &out, const void * p, const int n){
+    const unsigned char * b = (const unsigned char *)p;
+    uint16_t probe = 1;
+    if(*(const unsigned char *)&probe == 1){
+        for(int i = n - 1; i >= 0; --i){
+            out.push_back(b[i]);
+        }
+    }
+    else{
+        out.insert(out.end(), b, b + n);
+    }
+}
+static void putBig(std::vector<unsigned char> &out, const int32_t x){putBig(out, &x, 4);}
+static void putSignature(std::vector<unsigned char> &out, const char * s){out.insert(out.end(), s, s + 4);}
+
+PartialWriter::PartialWriter(const int maxTracks, const float sr, const int windowSize, const int hop, const int stream){
+    queue = new FrameQueue<Frame>(PARTIALQUEUEDEPTH, maxTracks);
+    running.store(false);
+    dropped.store(0);
+    sdif = smpf = nullptr;
+    memset(&header, 0, sizeof(header));
+    header.magic = PARTIALFILEMAGIC;
+    header.version = PARTIALFILEVERSION;
+    header.samplingRate = sr;
+    header.windowSize = windowSize;
+    header.hopSize = hop;
+    header.maxTracks = maxTracks;
+    partialIDs.assign(maxTracks, -1);
+    streamID = stream;
+    numFrames = nextID = 0;
+    lastIndex = -1;
+    failed = false;
+}
+
+PartialWriter::~PartialWriter(){
+    close();
+    delete queue;
+}
+
+bool PartialWriter::open(const std::string &sdifPath, const std::string &smpfPath){
+    std::vector<unsigned char> out;
+    close();
+    failed = false;
+    numFrames = nextID = 0;
+    lastIndex = -1;
+    std::fill(partialIDs.begin(), partialIDs.end(), -1);
+    dropped.store(0);
+    queue->clear();
+    if(!sdifPath.empty()){
+        if((sdif = fopen(sdifPath.c_str(), "wb")) == nullptr){
+            std::cout << "Error: couldn't open " << sdifPath << " for writing" << std::endl;
+            return false;
+        }
+        //file header frame: signature, size of what follows, spec version 3, standard types version 1
+        putSignature(out, "SDIF");
+        putBig(out, 8);
+        putBig(out, 3);
+        putBig(out, 1);
+        failed = fwrite(out.data(), 1, out.size(), sdif) != out.size();
+    }
+    if(!smpfPath.empty()){
+        if((smpf = fopen(smpfPath.c_str(), "wb")) == nullptr){
+            std::cout << "Error: couldn't open " << smpfPath << " for writing" << std::endl;
+            if(sdif != nullptr){
+                fclose(sdif);
+                sdif = nullptr;
+            }
+            return false;
+        }
+        chunks.clear();
+        failed = !writeBlock(&header, sizeof(header)) || failed;
+    }
+    running.store(true);
+    thread = std::thread(&PartialWriter::run, this);
+    return !failed;
+}
+
+bool PartialWriter::close(){
+    PartialFileTrailer trailer;
+    if(!running.exchange(false)){
+        return !failed;
+    }
+    thread.join();//drains whatever is still queued on the way out
+    if(smpf != nullptr){
+        failed = !flushChunk() || failed;
+        memset(&trailer, 0, sizeof(trailer));
+        trailer.tableOffset = (uint64_t)ftell(smpf);
+        trailer.numChunks = (uint32_t)chunks.size();
+        trailer.numFrames = (uint32_t)numFrames;
+        trailer.end = PARTIALFILEEND;
+        failed = (chunks.size() > 0 && !writeBlock(chunks.data(), sizeof(PartialFileChunk) * chunks.size())) || failed;
+        failed = !writeBlock(&trailer, sizeof(trailer)) || failed;
+        failed = fclose(smpf) != 0 || failed;
+        smpf = nullptr;
+    }
+    if(sdif != nullptr){
+        failed = fclose(sdif) != 0 || failed;
+        sdif = nullptr;
+    }
+    if(dropped.load() > 0){
+        std::cout << "Warning: " << dropped.load() << " frames were dropped before they could be written" << std::endl;
+    }
+    return !failed;
+}
+
+bool PartialWriter::push(const Frame &f){
+    Frame * slot = queue->write();
+    if(slot == nullptr){
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    slot->copy(f);
+    queue->push();
+    return true;
+}
+
+void PartialWriter::run(){
+    const Frame * frame;
+    bool more = true;
+    while(more){
+        more = running.load();//one last pass after close() to pick up the tail
+        while((frame = queue->front()) != nullptr){
+            if(sdif != nullptr){
+                writeSDIF(*frame);
+            }
+            if(smpf != nullptr){
+                writeSMPF(*frame);
+            }
+            numFrames++;
+            queue->pop();
+        }
+        if(more){
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));//polling keeps push() free of locks
+        }
+    }
+}
+
+void PartialWriter::writeSDIF(const Frame &f){
+    std::vector<unsigned char> out;
+    double time = (header.windowSize / 2 + (double)f.index * f.hopSize) / header.samplingRate;
+    float row[4];
+    int i, rows = 0, dataBytes, padding;
+    matrix.clear();
+    if(f.index != lastIndex + 1){//a frame went missing, and with it maybe a START: nothing before it carries on
+        std::fill(partialIDs.begin(), partialIDs.end(), -1);
+    }
+    lastIndex = f.index;
+    for(i = 0; i < f.numPartials; ++i){
+        const Frame::Partial &p = f.partials[i];
+        if(p.event == Frame::EVENT::START || partialIDs[p.track] < 0){
+            partialIDs[p.track] = nextID++;
+        }
+        if(p.isActive()){
+            row[0] = (float)partialIDs[p.track];
+            row[1] = p.frq;
+            row[2] = p.amp * p.gain;
+            row[3] = (float)(2.0 * M_PI * p.phs - M_PI);//ours are normalized to [0, 1) from atan2's [-pi, pi)
+            matrix.insert(matrix.end(), row, row + 4);
+            rows++;
+        }
+    }
+    dataBytes = rows * 4 * sizeof(float);
+    padding = (8 - dataBytes % 8) % 8;
+    out.reserve(32 + dataBytes + padding);
+    //frame header: signature, size of the rest of the frame, time, stream, one matrix
+    putSignature(out, "1TRC");
+    putBig(out, 16 + 16 + dataBytes + padding);
+    putBig(out, &time, 8);
+    putBig(out, streamID);
+    putBig(out, 1);
+    //matrix header: signature, float32, rows of (index, frequency, amplitude, phase)
+    putSignature(out, "1TRC");
+    putBig(out, 0x0004);
+    putBig(out, rows);
+    putBig(out, 4);
+    for(i = 0; i < rows * 4; ++i){
+        putBig(out, &matrix[i], 4);
+    }
+    out.insert(out.end(), padding, 0);
+    if(fwrite(out.data(), 1, out.size(), sdif) != out.size()){
+        failed = true;
+    }
+}
+
+void PartialWriter::writeSMPF(const Frame &f){
+    index.push_back(f.index);
+    hopSize.push_back(f.hopSize);
+    activeTracks.push_back(f.activeTracks);
+    denormFactor.push_back(f.denormFactor);
+    firstPartial.push_back((uint32_t)track.size());
+    numPartials.push_back((uint32_t)f.numPartials);
+    for(int i = 0; i < f.numPartials; ++i){
+        const Frame::Partial &p = f.partials[i];
+        track.push_back(p.track);
+        amp.push_back(p.amp);
+        frq.push_back(p.frq);
+        phs.push_back(p.phs);
+        gain.push_back(p.gain);
+        event.push_back((uint8_t)p.event);
+        status.push_back((uint8_t)p.status);
+    }
+    if(index.size() == PARTIALCHUNKFRAMES && !flushChunk()){
+        failed = true;
+    }
+}
+
+bool PartialWriter::flushChunk(){
+    PartialFileChunk chunk;
+    bool ok;
+    if(index.empty()){
+        return true;
+    }
+    chunk.offset = (uint64_t)ftell(smpf);
+    chunk.numFrames = (uint32_t)index.size();
+    chunk.numPartials = (uint32_t)track.size();
+    //in PartialFileColumns order
+    ok = writeBlock(index.data(), 4 * index.size()) && writeBlock(hopSize.data(), 4 * hopSize.size()) &&
+         writeBlock(activeTracks.data(), 4 * activeTracks.size()) && writeBlock(denormFactor.data(), 4 * denormFactor.size()) &&
+         writeBlock(firstPartial.data(), 4 * firstPartial.size()) && writeBlock(numPartials.data(), 4 * numPartials.size()) &&
+         writeBlock(track.data(), 4 * track.size()) && writeBlock(amp.data(), 4 * amp.size()) &&
+         writeBlock(frq.data(), 4 * frq.size()) && writeBlock(phs.data(), 4 * phs.size()) &&
+         writeBlock(gain.data(), 4 * gain.size()) && writeBlock(event.data(), event.size()) &&
+         writeBlock(status.data(), status.size());
+    chunks.push_back(chunk);
+    index.clear();
+    hopSize.clear();
+    activeTracks.clear();
+    denormFactor.clear();
+    firstPartial.clear();
+    numPartials.clear();
+    track.clear();
+    amp.clear();
+    frq.clear();
+    phs.clear();
+    gain.clear();
+    event.clear();
+    status.clear();
+    return ok;
+}
+
+bool PartialWriter::writeBlock(const void * data, const size_t bytes){
+    static const unsigned char zeros[8] = {0};
+    size_t padding = (8 - bytes % 8) % 8;
+    if(bytes > 0 && fwrite(data, 1, bytes, smpf) != bytes){
+        return false;
+    }
+    return padding == 0 || fwrite(zeros, 1, padding, smpf) == padding;
+}
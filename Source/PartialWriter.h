@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    PartialWriter.h
+    Created: 17 Oct 2026 5:50:54am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef PARTIALWRITER_H_INCLUDED
+#define PARTIALWRITER_H_INCLUDED
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FrameQueue.h"
+#include "PartialFile.h"
+#include "Track.h"
+
+#define PARTIALQUEUEDEPTH 64 //frames the writer thread can fall behind by, power of two
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  PartialWriter Class (streams a model's frames to disk)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//the model hands every frame to push(), which copies it into a preallocated queue and returns: no locks,
+//allocation or i/o on the calling thread. a background thread drains the queue into an SDIF file (one
+//1TRC matrix per frame, active partials only) and/or an SMPF file (every frame as is, see PartialFile.h).
+//
+//SDIF amplitudes are what the partial actually sounds at (amp * gain), phases are in radians and times
+//are the centre of the analysis window. a 1TRC index names one partial from birth to death: track slots are
+//reused, so every START gets a new one, and so does everything after a gap in the frames, whose STARTs may
+//have gone with it. frames that don't fit in the queue are dropped and counted
+class PartialWriter{
+private:
+    FrameQueue<Frame> * queue;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<int> dropped;
+    FILE * sdif, * smpf;
+    PartialFileHeader header;
+    std::vector<PartialFileChunk> chunks;
+    //the chunk being filled, one vector per column
+    std::vector<int32_t> index, hopSize, activeTracks, track;
+    std::vector<uint32_t> firstPartial, numPartials;
+    std::vector<float> denormFactor, amp, frq, phs, gain;
+    std::vector<uint8_t> event, status;
+    std::vector<float> matrix;//one SDIF frame's rows, big endian
+    std::vector<int32_t> partialIDs;//per track slot, the SDIF index of the partial in it. -1 until it's seen
+    int streamID, numFrames, nextID, lastIndex;//lastIndex: the last frame's, to spot gaps
+    bool failed;
+
+    void run();
+    void writeSDIF(const Frame &f);
+    void writeSMPF(const Frame &f);
+    bool flushChunk();
+    bool writeBlock(const void * data, const size_t bytes);//to smpf, padded to 8 bytes
+public:
+    PartialWriter(const int maxTracks, const float sr, const int windowSize, const int hopSize, const int stream = 0);
+    ~PartialWriter();//closes
+
+    //not realtime safe. either path can be empty to skip that format
+    bool open(const std::string &sdifPath, const std::string &smpfPath);
+    bool close();//drains the queue, finishes both files. false if anything failed to write
+
+    bool push(const Frame &f);//realtime safe, false if the frame had to be dropped
+
+    //getters
+    int getDropped() const{return dropped.load();}
+    int getNumFrames() const{return numFrames;}//written, only meaningful after close()
+};
+
+#endif  // PARTIALWRITER_H_INCLUDED
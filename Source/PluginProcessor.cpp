@@ -10,24 +10,48 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "FFTPlans.h"
 
 
 //==============================================================================
 SmodelsAudioProcessor::SmodelsAudioProcessor()
 {
     UIUpdateFlag = true;
-    SpectrogramUpdateFlag = true;
     analysisSize = 1024;
+    hopFactor = 4;
+    resolutions = 1;
     zeroPadding = true;
+    windowType = windows::TYPE::GAUSSIAN;
+    threadedAnalysis = 0.0f;
+    spectralSynthesis = 0.0f;
+    reassignment = 0.0f;
+    residualLevel = 0.0f;
+    displayScale = DisplaySpectrum::SCALE::LOG;
+    displayReduction = DisplaySpectrum::REDUCTION::MAX;
+    //one worker per channel, leaving a core for the audio thread. job slots for the running set, the one on
+    //offer and everything the builder keeps cached
+    pool = new AnalysisPool(JucePlugin_MaxNumInputChannels * (MODELSETCACHE + 2),
+                            jmin(JucePlugin_MaxNumInputChannels, jmax(1, (int)std::thread::hardware_concurrency() - 1)));
     //std::cout << "sample rate at constructor: " << (float)getSampleRate() << std::endl;
     //analyses = new Analysis[0];
     //smodels = new SinusoidalModel[JucePlugin_MaxNumInputChannels];
     
-    for(int i = 0; i < JucePlugin_MaxNumInputChannels; ++i){
-        //analyses[i].init(Analysis::WINDOW::HANN, analysisSize, 4, (float)sampleRate, zeroPadding);
-        smodels.add(new SinusoidalModel(Analysis::WINDOW::GAUSSIAN, analysisSize, 4, 44100, zeroPadding, Wavetable<float>::WAVEFORM::SINE, 2048));
-        smodels[i]->init();
+    //plans are shared by every instance in the process, and the wisdom lets the next session skip measuring
+    if(fftplans::getWisdomFile().empty()){
+        File wisdom = File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("smodels").getChildFile("fftw.wisdom");
+        wisdom.getParentDirectory().createDirectory();
+        fftplans::setWisdomFile(wisdom.getFullPathName().toStdString());
     }
+    ModelConfig config;
+    config.windowSize = analysisSize;
+    config.hopFactor = hopFactor;
+    config.resolutions = resolutions;
+    config.window = windowType;
+    config.padded = zeroPadding;
+    current.store(new ModelSet(config, JucePlugin_MaxNumInputChannels, 44100, pool));
+    displayed = nullptr;
+    builder = new ModelBuilder(config, JucePlugin_MaxNumInputChannels, 44100, pool);
+    builder->start();
     //testWvTble = new Wavetable<float>;
     //testOsc = new Oscillator<float>;
     //std::cout << "processor constructor loc: " << this << std::endl;
@@ -40,6 +64,12 @@ SmodelsAudioProcessor::SmodelsAudioProcessor()
 
 SmodelsAudioProcessor::~SmodelsAudioProcessor()
 {
+    builder = nullptr;//joins its thread first, so nothing new is offered while we tear down
+    delete current.load();//models wait for their outstanding jobs, so they have to go before the pool
+    pool = nullptr;
+    //every plan nothing holds any more, so they don't pile up as instances come and go. that includes ones another
+    //instance planned ahead, but the wisdom file has them, so getting one back doesn't mean measuring again
+    fftplans::purge();
     //delete[] analyses;
     //delete[] smodels;
     //delete testWvTble;
@@ -54,26 +84,139 @@ const String SmodelsAudioProcessor::getName() const
 
 int SmodelsAudioProcessor::getNumParameters()
 {
-    return 0;
+    return NumParams;
 }
 
 float SmodelsAudioProcessor::getParameter (int index)
 {
-    return 0.0f;
+    switch(index){
+        case ThreadedAnalysis:
+            return threadedAnalysis;
+        case SpectralMode:
+            return spectralSynthesis;
+        //the choices are spread evenly over [0, 1], report the middle of ours
+        case WindowSize:
+            for(int i = 0; i < ModelBuilder::numWindowSizes; ++i){
+                if(ModelBuilder::windowSizes[i] == analysisSize){
+                    return (i + 0.5f) / ModelBuilder::numWindowSizes;
+                }
+            }
+            return 0.0f;
+        case HopFactor:
+            for(int i = 0; i < ModelBuilder::numHopFactors; ++i){
+                if(ModelBuilder::hopFactors[i] == hopFactor){
+                    return (i + 0.5f) / ModelBuilder::numHopFactors;
+                }
+            }
+            return 0.0f;
+        case ZeroPadding:
+            return (zeroPadding)?1.0f:0.0f;
+        case Residual:
+            return residualLevel;
+        case Resolutions:
+            return (resolutions - 0.5f) / MAXRESOLUTIONS;
+        case Reassignment:
+            return reassignment;
+        case Window:
+            return ((int)windowType + 0.5f) / windows::numTypes;
+        default:
+            return 0.0f;
+    }
 }
 
 void SmodelsAudioProcessor::setParameter (int index, float newValue)
 {
+    switch(index){
+        case ThreadedAnalysis:
+            threadedAnalysis = newValue;
+            updateLatency();
+            break;
+        case SpectralMode:
+            spectralSynthesis = newValue;
+            break;
+        case WindowSize:
+            analysisSize = ModelBuilder::windowSizes[jlimit(0, ModelBuilder::numWindowSizes - 1,
+                                                            (int)(newValue * ModelBuilder::numWindowSizes))];
+            requestConfig();
+            break;
+        case HopFactor:
+            hopFactor = ModelBuilder::hopFactors[jlimit(0, ModelBuilder::numHopFactors - 1,
+                                                        (int)(newValue * ModelBuilder::numHopFactors))];
+            requestConfig();
+            break;
+        case ZeroPadding:
+            zeroPadding = newValue >= 0.5f;
+            requestConfig();
+            break;
+        case Residual:
+            residualLevel = newValue;
+            break;
+        case Resolutions:
+            resolutions = jlimit(1, MAXRESOLUTIONS, (int)(newValue * MAXRESOLUTIONS) + 1);
+            requestConfig();
+            break;
+        case Reassignment:
+            reassignment = newValue;
+            break;
+        case Window:
+            windowType = (windows::TYPE)jlimit(0, windows::numTypes - 1, (int)(newValue * windows::numTypes));
+            requestConfig();
+            break;
+        default:
+            break;
+    }
 }
 
 const String SmodelsAudioProcessor::getParameterName (int index)
 {
-    return String::empty;
+    switch(index){
+        case ThreadedAnalysis:
+            return "Threaded Analysis";
+        case SpectralMode:
+            return "Spectral Synthesis";
+        case WindowSize:
+            return "Window Size";
+        case HopFactor:
+            return "Hop Factor";
+        case ZeroPadding:
+            return "Zero Padding";
+        case Residual:
+            return "Residual";
+        case Resolutions:
+            return "Resolutions";
+        case Reassignment:
+            return "Reassignment";
+        case Window:
+            return "Window";
+        default:
+            return String::empty;
+    }
 }
 
 const String SmodelsAudioProcessor::getParameterText (int index)
 {
-    return String::empty;
+    switch(index){
+        case ThreadedAnalysis:
+            return (threadedAnalysis >= 0.5f)?"On":"Off";
+        case SpectralMode:
+            return (spectralSynthesis >= 0.5f)?"On":"Off";
+        case WindowSize:
+            return String(analysisSize);
+        case HopFactor:
+            return String(hopFactor);
+        case ZeroPadding:
+            return (zeroPadding)?"On":"Off";
+        case Residual:
+            return (residualLevel > 0.0f)?String(residualLevel, 2):"Off";
+        case Resolutions:
+            return String(resolutions);
+        case Reassignment:
+            return (reassignment >= 0.5f)?"On":"Off";
+        case Window:
+            return windows::getName(windowType);
+        default:
+            return String::empty;
+    }
 }
 
 const String SmodelsAudioProcessor::getInputChannelName (int channelIndex) const
@@ -152,11 +295,13 @@ void SmodelsAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    int numChannels = getNumInputChannels();
-    for(int i = 0; i < numChannels; ++i){
-        //analyses[i].init(Analysis::WINDOW::HANN, analysisSize, 4, (float)sampleRate, zeroPadding);
-        smodels[i]->init();
+    //playback is stopped, so this is a safe place to pick up a set that's already waiting
+    ModelSet * set = builder->take();
+    if(set != nullptr){
+        builder->retire(current.exchange(set));
     }
+    current.load()->init();
+    updateLatency();
 
     //testing only
     //delete[] analyses;
@@ -191,51 +336,25 @@ void SmodelsAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer&
     // audio processing...
     
     
-    int numChannels = buffer.getNumChannels(), numSamples = buffer.getNumSamples(), channel, index;
+    int numSamples = buffer.getNumSamples(), boundary;
     //std::cout << "Callback size: " << callbackSize << std::endl;
-    float * channelData, sample;
-    bool update = false;
-    for (channel = 0; channel < numChannels; ++channel){
-        channelData = buffer.getSampleData(channel);
-        for (index = 0; index < numSamples; ++index){
-            sample = channelData[index];
-            //if(analyses[channel](sample)){//write values to analysis buffer
-            if(smodels[channel]->operator()(sample)){//write values to analysis buffer
-                //take an fft now!
-                //analyses[channel].transform(Analysis::TRANSFORM::FFT);
-                //analyses[channel].transform(Analysis::TRANSFORM::IFFT);
-                smodels[channel]->transform(Analysis::TRANSFORM::FFT);
-                smodels[channel]->breakpoint();
-                update = true;
-            }
-        }
+    ModelSet * set = current.load(), * next;
+    bool threaded = threadedAnalysis >= 0.5f;
+    float residual = residualLevel;
+    SynthesisEngine::MODE mode = (spectralSynthesis >= 0.5f)?SynthesisEngine::MODE::SPECTRAL:SynthesisEngine::MODE::OSCILLATORS;
+    //a rebuilt set only goes in where the old one finishes a hop, so its last frame is rendered in full. every
+    //model in a set has the same hop size and has been fed the same samples, so channel 0 speaks for all of them
+    boundary = set->getModel(0)->getSamplesUntilHop();
+    if(boundary <= numSamples && (next = builder->take()) != nullptr){
+        processSegment(set, buffer, 0, boundary, threaded, mode, residual);
+        current.store(next);
+        builder->retire(set);//deleted or cached on the builder thread
+        updateLatency();//the new set's hop
+        processSegment(next, buffer, boundary, numSamples - boundary, threaded, mode, residual);
     }
-    //now that we've analyzed the input, we can replace that data with the output from the model
-    
-    for (channel = 0; channel < numChannels; ++channel){
-		if(smodels[channel]->getNumActive() > 0){
-			channelData = buffer.getSampleData(channel);
-//			rms = smodels[channel]->getAnalysisResults(Analysis::PARAMETER::RMS);
-			for (index = 0; index < numSamples; ++index){
-				channelData[index] = smodels[channel]->operator()();
-            
-            //testing only:
-            /*channelData[index] = testOsc->next();
-            sweepFrac = (float)sweepCounter/sweepMax;
-            testOsc->setFrequency(sweepFrac * sweepTo);
-            sweepCounter++;
-            if(sweepCounter == sweepMax){
-                sweepCounter = 1;
-            }*/
-            /*//this logger still blocks...
-             std::stringstream message;
-            message << "Sample " << index << ": " << channelData[index] << std::endl;
-            fl->writeToLog(message.str());*/
-                               //}
-			}
-        }
+    else{
+        processSegment(set, buffer, 0, numSamples, threaded, mode, residual);
     }
-    SpectrogramUpdateFlag = update?true:false;
     // In case we have more outputs than inputs, we'll clear any output
     // channels that didn't contain input data, (because these aren't
     // guaranteed to be empty - they may contain garbage).
@@ -270,15 +389,70 @@ void SmodelsAudioProcessor::setStateInformation (const void* data, int sizeInByt
     // whose contents will have been created by the getStateInformation() call.
 }
 
+void SmodelsAudioProcessor::processSegment(ModelSet * set, AudioSampleBuffer &buffer, const int start, const int n,
+                                           const bool threaded, const SynthesisEngine::MODE mode, const float residual){
+    int numChannels = jmin(buffer.getNumChannels(), set->getNumModels());
+    float * channelData;
+    SinusoidalModel * model;
+    if(n <= 0){
+        return;
+    }
+    for(int channel = 0; channel < numChannels; ++channel){
+        channelData = buffer.getSampleData(channel, start);
+        model = set->getModel(channel);
+        model->setThreaded(threaded);
+        model->getSynthesis().setMode(mode);
+        model->setResidual(residual);
+        model->setDisplayMode(displayScale, displayReduction);
+        model->setEstimator((reassignment >= 0.5f)?Analysis::ESTIMATOR::REASSIGNMENT:Analysis::ESTIMATOR::PARABOLIC);
+        //analysis and resynthesis in place, split at hop boundaries inside the model
+        if(model->process(channelData, channelData, n) > 0){
+            model->updateDisplay();//does nothing until the editor has taken the last one
+        }
+    }
+}
+
+void SmodelsAudioProcessor::requestConfig(){//called from setParameter, so nothing here may block
+    ModelConfig config;
+    config.windowSize = analysisSize;
+    config.hopFactor = hopFactor;
+    config.resolutions = resolutions;
+    config.window = windowType;
+    config.padded = zeroPadding;
+    builder->request(config);//the latency follows when it's swapped in
+}
+
+//the display reads the set that was current when it was pinned. the builder won't delete it until it's unpinned,
+//however many swaps go by in between
+void SmodelsAudioProcessor::pinDisplay(){
+    displayed = builder->pin(current);
+}
+
+void SmodelsAudioProcessor::unpinDisplay(){
+    displayed = nullptr;
+    builder->unpin();
+}
+
 int SmodelsAudioProcessor::getAnalysisSize() const{
-    return (zeroPadding)?analysisSize * 2:analysisSize;
+    const ModelConfig &config = displayed->getConfig();
+    return (config.padded)?config.windowSize * 3:config.windowSize;//the same padding Analysis uses
 }
 
-float * SmodelsAudioProcessor::getAnalysisResults(const int channel, const Analysis::PARAMETER p) const{
-    return smodels[channel]->getAnalysisResults(p);
+//a set that's just been swapped in shows nothing until its models have published something
+bool SmodelsAudioProcessor::refreshSpectrum(const int channel){
+    return (channel < displayed->getNumModels())?displayed->getModel(channel)->refreshDisplay():false;
 }
-float SmodelsAudioProcessor::getAmpNormFactor(const int channel) const{
-    return smodels[channel]->getAmpNormFactor();
+
+const DisplaySpectrum * SmodelsAudioProcessor::getSpectrum(const int channel) const{
+    return (channel < displayed->getNumModels())?&displayed->getModel(channel)->getDisplay():nullptr;
+}
+
+void SmodelsAudioProcessor::updateLatency(){
+    //threaded analysis renders from the frame analyzed one hop earlier, at the hop of the set that's running. with
+    //more than one resolution every window is centred on the bass window's centre, which puts ours 1.5 windows back
+    ModelSet * set = current.load();
+    const ModelConfig &config = set->getConfig();
+    setLatencySamples(((threadedAnalysis >= 0.5f)?config.windowSize / config.hopFactor:0) + set->getModel(0)->getAnalysisDelay());
 }
 
 //==============================================================================
@@ -13,6 +13,8 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "SinusoidalModel.h"
+#include "AnalysisPool.h"
+#include "ModelSet.h"
 #include "Oscillator.h"
 #include <sstream>
 //==============================================================================
@@ -68,9 +70,26 @@ public:
     void setStateInformation (const void* data, int sizeInBytes);
 
     //Custom Methods, Params, and Public Data
+    //the editor's end of each channel's display spectrum, message thread only and between pinDisplay() and
+    //unpinDisplay(), which keep the set it comes from alive. see SinusoidalModel::updateDisplay
+    void pinDisplay();
+    void unpinDisplay();
     int getAnalysisSize() const;
-    float * getAnalysisResults(const int channel, const Analysis::PARAMETER p) const;
-	float getAmpNormFactor(const int channel) const;
+    bool refreshSpectrum(const int channel);//true if getSpectrum() has something newer to show
+    const DisplaySpectrum * getSpectrum(const int channel) const;//nullptr past the last channel
+    void setDisplayMode(const DisplaySpectrum::SCALE s, const DisplaySpectrum::REDUCTION r){displayScale = s; displayReduction = r;}
+    enum Parameters{
+        ThreadedAnalysis = 0,//run each channel's hop analysis on the worker pool, adds a hop of latency
+        SpectralMode,//resynthesize with one inverse FFT per hop instead of the oscillator bank
+        WindowSize,//these three rebuild the models off the audio thread, see ModelBuilder
+        HopFactor,
+        ZeroPadding,
+        Residual,//level of the noise standing in for whatever the partials miss, 0 skips its analysis too
+        Resolutions,//1 to MAXRESOLUTIONS windows, each handling its own band. rebuilds the models too
+        Reassignment,//reassigned peak frequencies instead of parabolic interpolation, as good without zero padding
+        Window,//analysis window, one of windows::TYPE. rebuilds the models too
+        NumParams
+    };
     /*enum Parameters{
         MasterBypass = 0,
         Mix,
@@ -89,18 +108,25 @@ public:
     bool NeedsUIUpdate(){return UIUpdateFlag;};
     void ClearUIUpdateFlag(){UIUpdateFlag = false;};
     void RaiseUIUpdateFlag(){UIUpdateFlag = true;};
-    bool NeedsSpectrogramUpdate(){return SpectrogramUpdateFlag;};
-    void ClearSpectrogramUpdateFlag(){SpectrogramUpdateFlag = false;};
-    void RaiseSpectrogramUpdateFlag(){SpectrogramUpdateFlag = true;};
     
 private:
     //Private Data, helper methods, etc
-    int analysisSize;
+    int analysisSize, hopFactor, resolutions;//what the host asked for, current may still be running the old values
     bool zeroPadding;
+    windows::TYPE windowType;
     //Analysis * analyses;
-    OwnedArray<SinusoidalModel> smodels;
+    std::atomic<ModelSet *> current;//swapped by the audio thread only, at a hop boundary
+    ModelSet * displayed;//pinned by the editor, message thread only
+    ScopedPointer<ModelBuilder> builder;
+    ScopedPointer<AnalysisPool> pool;
+    float threadedAnalysis, spectralSynthesis, residualLevel, reassignment;
+    DisplaySpectrum::SCALE displayScale;//how the models lay out the spectra they publish
+    DisplaySpectrum::REDUCTION displayReduction;
+    void updateLatency();
+    void requestConfig();
+    void processSegment(ModelSet * set, AudioSampleBuffer &buffer, const int start, const int n, const bool threaded,
+                        const SynthesisEngine::MODE mode, const float residual);
     bool UIUpdateFlag;
-    bool SpectrogramUpdateFlag;
     
     
     
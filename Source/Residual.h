@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    Residual.h
+    Created: 17 Oct 2026 6:00:15am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef RESIDUAL_H_INCLUDED
+#define RESIDUAL_H_INCLUDED
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  Residual envelope bands
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//whatever the partials don't account for is kept as one level per critical band, the same bands whatever
+//the FFT size, so the analysis and the noise synthesis don't have to agree on anything else.
+//a level is the noise's amplitude spectral density (sqrt of variance per Hz), normalized by the frame's
+//loudest bin: synthesis multiplies it by the frame's denormFactor
+#define RESIDUALBANDS 25
+
+namespace residual{
+    //Zwicker's critical band edges in Hz, the last band runs up to nyquist
+    static const float edges[RESIDUALBANDS] = {
+        0.0f, 100.0f, 200.0f, 300.0f, 400.0f, 510.0f, 630.0f, 770.0f, 920.0f, 1080.0f, 1270.0f, 1480.0f, 1720.0f,
+        2000.0f, 2320.0f, 2700.0f, 3150.0f, 3700.0f, 4400.0f, 5300.0f, 6400.0f, 7700.0f, 9500.0f, 12000.0f, 15500.0f
+    };
+
+    inline float getCentre(const int b, const float nyquist){//a band's upper edge never goes past nyquist
+        float upper = (b + 1 < RESIDUALBANDS && edges[b + 1] < nyquist)?edges[b + 1]:nyquist;
+        return 0.5f * (edges[b] + ((upper > edges[b])?upper:edges[b]));
+    }
+}
+
+#endif  // RESIDUAL_H_INCLUDED
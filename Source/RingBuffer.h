@@ -11,11 +11,15 @@
 #ifndef RINGBUFFER_H_INCLUDED
 #define RINGBUFFER_H_INCLUDED
 
+#include <algorithm>
+#include <cstdint>
+
 template <class T>
 class RingBuffer {
 private:
     uint32_t size, mask, readPos, writePos;
     T * data;
+    bool owner;
 public:
     RingBuffer(const int s = 0){
         size = s; //size must be power of two!
@@ -23,12 +27,23 @@ public:
 		//example: size = 1024
 		//size: 00000000000000000000010000000000
 		//mask: 00000000000000000000001111111111
-        data = new T[size];
+        data = new T[size]();
         readPos = 0;
         writePos = 0;
+        owner = true;
+    }
+    RingBuffer(T * storage, const int s){//s zeroed Ts that someone else owns, e.g. an Arena
+        size = s;
+        mask = size - 1;
+        data = storage;
+        readPos = 0;
+        writePos = 0;
+        owner = false;
     }
     ~RingBuffer(){
-        delete[] data;
+        if(owner){
+            delete[] data;
+        }
     }
     T read(){
 		readPos &= mask;
@@ -38,6 +53,47 @@ public:
 		writePos &= mask;
         data[writePos++] = x;
     }
+    void write(const T * x, const int n){//block write, at most two copies around the wrap point
+        uint32_t first, count = n;
+        writePos &= mask;
+        first = std::min(count, size - writePos);
+        std::copy(x, x + first, data + writePos);
+        std::copy(x + first, x + count, data);
+        writePos += count;
+    }
+    //overlap-add: accumulate n values starting at the write position, then move it on by advance (<= n)
+    void add(const T * x, const int n, const int advance){
+        uint32_t first, count = n;
+        writePos &= mask;
+        first = std::min(count, size - writePos);
+        for(uint32_t i = 0; i < first; ++i){
+            data[writePos + i] += x[i];
+        }
+        for(uint32_t i = first; i < count; ++i){
+            data[i - first] += x[i];
+        }
+        writePos += advance;
+    }
+    void take(T * out, const int n){//block read that zeroes what it read, so add() can reuse the space
+        uint32_t first, count = n;
+        readPos &= mask;
+        first = std::min(count, size - readPos);
+        std::copy(data + readPos, data + readPos + first, out);
+        std::fill(data + readPos, data + readPos + first, T());
+        std::copy(data, data + count - first, out + first);
+        std::fill(data, data + count - first, T());
+        readPos += count;
+    }
+    void latest(T * out, const int n, const int offset = 0) const{//the n values written before the last offset, oldest first
+        uint32_t start = (writePos - offset - n) & mask, first = std::min((uint32_t)n, size - start);
+        std::copy(data + start, data + start + first, out);
+        std::copy(data, data + n - first, out + first);
+    }
+    void clear(){
+        std::fill(data, data + size, T());
+        readPos = writePos = 0;
+    }
+    int getSize() const{return size;}
 };
 
 
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    SIMD.h
+    Created: 17 Oct 2026 4:29:56am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef SIMD_H_INCLUDED
+#define SIMD_H_INCLUDED
+
+#include <cstdint>
+#include <cstdlib>
+
+//instruction sets we have kernels for. x86 kernels are compiled with per-function target attributes
+//and picked at runtime, so the rest of the plugin doesn't need to be built with -mavx2
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_HAS_AVX2 1
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define SIMD_ALIGNMENT 64 //cache line, also covers AVX2's 32 byte requirement
+#define SIMD_MAXLANES 8
+
+namespace simd{
+    enum class ISA{SCALAR, SSE2, AVX2, NEON};
+
+    //widest instruction set available on this machine, optionally capped (useful for testing the fallbacks)
+    inline ISA detect(const ISA cap = ISA::AVX2){
+        ISA isa = ISA::SCALAR;
+#if SIMD_X86
+        isa = ISA::SSE2;//baseline on every x86_64 we ship on
+#if SIMD_HAS_AVX2
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+            isa = ISA::AVX2;
+        }
+#endif
+#elif SIMD_NEON
+        isa = ISA::NEON;
+#endif
+        if(cap == ISA::SCALAR || (cap == ISA::SSE2 && isa == ISA::AVX2)){
+            isa = cap;
+        }
+        return isa;
+    }
+
+    inline int lanes(const ISA isa){
+        switch(isa){
+            case ISA::AVX2:
+                return 8;
+            case ISA::SSE2:
+            case ISA::NEON:
+                return 4;
+            default:
+                return 1;
+        }
+    }
+
+    inline int roundUp(const int n, const int multiple){
+        return ((n + multiple - 1) / multiple) * multiple;
+    }
+
+    //over-allocates and stashes the offset in front of the aligned block so alignedFree can recover it
+    inline void * alignedAlloc(const size_t bytes){
+        unsigned char * raw = (unsigned char *)malloc(bytes + SIMD_ALIGNMENT + sizeof(uintptr_t)), * aligned;
+        if(raw == nullptr){
+            return nullptr;
+        }
+        aligned = (unsigned char *)(((uintptr_t)raw + sizeof(uintptr_t) + SIMD_ALIGNMENT - 1) & ~(uintptr_t)(SIMD_ALIGNMENT - 1));
+        ((uintptr_t *)aligned)[-1] = (uintptr_t)(aligned - raw);
+        return aligned;
+    }
+    inline void alignedFree(void * p){
+        if(p != nullptr){
+            unsigned char * aligned = (unsigned char *)p;
+            free(aligned - ((uintptr_t *)aligned)[-1]);
+        }
+    }
+}
+
+#endif  // SIMD_H_INCLUDED
@@ -10,17 +10,12 @@
 
 #include "SinusoidalModel.h"
 #include "Track.h"
+#include "PartialWriter.h"
+#include "AnalysisPool.h"
+#include "Instrumentation.h"
 #define CRUMB 0.0000001
 #define ONEOVERTWENTY 0.05
 
-bool matchSort(const TrackMatch &a, const TrackMatch &b){
-	float frqDiffA = a.frqDiff, frqDiffB = b.frqDiff;
-	if(frqDiffA == frqDiffB){//if tied, sort by overall distanceSq
-		return a.distSq < b.distSq;
-	}
-	return frqDiffA < frqDiffB;//otherwise sort by frqDiff
-}
-
 float SinusoidalModel::getCurve(const ThresholdFunction tf, const float x){
 	switch(tf){
 		case ThresholdFunction::oneOverX:
@@ -41,59 +36,211 @@ float SinusoidalModel::getCurve(const ThresholdFunction tf, const float x){
 }
 
 SinusoidalModel::SinusoidalModel(const Analysis::WINDOW w, const int ws, const int hf, const float sr, const bool p,
-                                 Wavetable<float>::WAVEFORM wf, const int wts){
+                                 Wavetable<float>::WAVEFORM wf, const int wts, const int r){
     windowSize = ws;
     wavetable = new Wavetable<float>(wf, wts);
-    analysis = new Analysis(w, ws, hf, sr, p);
+    analysis = new Analysis(w, ws, hf, sr, p, false);//its arrays live in our arena
     maxTracks = analysis->getNumBins();
     hopSize = analysis->getAppetite();
+    maxFreq = (int)((maxTracks - 1) * analysis->getSamplingRateOverSize());//highest bin's frequency
+    residualLobeWidth = RESIDUALLOBEBINS * 2.0f * (maxTracks - 1) / windowSize;//in padded bins
+    planResolutions(w, r, sr, p);
     
-    tracks = new Track[maxTracks];
-    oscillators = new Oscillator<float>[maxTracks];
-	
+    Arena sizing;
+    carve(sizing);
+    arena = new Arena(sizing.getUsed());
+    carve(*arena);
+    analysis->prepare();
+    synthesis = new SynthesisEngine(wavetable, sr, maxTracks, analysis->getHopSize());
+	frames = new FrameQueue<Frame>(FRAMEQUEUEDEPTH, maxTracks);
+	display = new TripleBuffer<DisplaySpectrum>(SPECTRUMDISPLAYBINS);
+	displayColumns = std::min(SPECTRUMDISPLAYBINS, maxTracks - 2);
+	displayEdges[(int)DisplaySpectrum::SCALE::LINEAR] = new int[displayColumns + 1];
+	displayEdges[(int)DisplaySpectrum::SCALE::LOG] = new int[displayColumns + 1];
+	displayScale.store(DisplaySpectrum::SCALE::LOG);
+	displayReduction.store(DisplaySpectrum::REDUCTION::MAX);
+	kernels = spectrum::select();
 	
 	float * frequencies = &analysis->getFrequencies();
-	int i, maxFreq = (int)frequencies[maxTracks - 1];
-    frequencyThresholds = new float[maxFreq]{0.0};
-    peakThresholds = new float[maxFreq]{0.0};
-    magnitudeThresholds = new float[maxTracks]{0.0};
-	detected = new TrackMatch[maxTracks];
-    matches = new bool[maxTracks]{false};
-	candidates = new TrackMatch[maxTracks];
+	int i;
+	numPeaks = numMatched = 0;
+	numBorn = numKilled = numStolen = numSidelobes = 0;
+	pool = nullptr;
+	recorder = nullptr;
+	job = -1;
+	threaded = false;
+	requested.store(0);
+	residual.store(false);
+	droppedHops = 0;
+	droppedFrames = 0;
+	hopCount = 0;
 	
 	samplingRateOverSize = analysis->getSamplingRateOverSize();
 	magThreshFnc = ThresholdFunction::logX;
 	freqThreshFnc = ThresholdFunction::logXOverX;
 	magThresholdFactor = 2.0; //[?, ?]
 	frqThresholdFactor = 50.0; //[?, ?]
-	peakThresholdFactor = 8.0;
-	std::cout << "Magnitude/Frequency Thresholds: " << std::endl;
+	//std::cout << "Magnitude/Frequency Thresholds: " << std::endl;
     for(i = 0; i < maxFreq; ++i){
 		frequencyThresholds[i] = 2.0 * log10f(i) + frqThresholdFactor * log10f(i + CRUMB) / (i + CRUMB);
-		//        peakThresholds[i] = (1.0 / (peakThresholdFactor * logf(frequencies[maxTracks - i])) + CRUMB);
-		peakThresholds[i] = (1.0 / (peakThresholdFactor * logf(i)) + CRUMB);
 	}
     for(i = 0; i < maxTracks; ++i){
-        oscillators[i].init(wavetable, sr);
         //adjust thresholds according to frequency range
         magnitudeThresholds[i] = 20.0 * log10f(1.0 / (magThresholdFactor * frequencies[i]) + CRUMB);
-		std::cout << "Bin " << i << " frq: " << frequencies[i] << std::endl <<
-		"M: " << magnitudeThresholds[i] << ", F: " << frequencyThresholds[i] << ", P: " << peakThresholds[i] << std::endl;
+		//std::cout << "Bin " << i << " frq: " << frequencies[i] << std::endl <<
+		//"M: " << magnitudeThresholds[i] << ", F: " << frequencyThresholds[i] << std::endl;
+    }
+    prepareResolutions(sr);
+    prepareResidual();
+    //both column layouts, so switching between them never has to allocate or race the producer
+    float frequency, high = samplingRateOverSize * (maxTracks - 1);
+    for(i = 0; i < displayColumns; ++i){
+        displayEdges[(int)DisplaySpectrum::SCALE::LINEAR][i] = 1 + (int)((long long)i * (maxTracks - 2) / displayColumns);
+        frequency = SPECTRUMDISPLAYLOW * powf(high / SPECTRUMDISPLAYLOW, (float)i / displayColumns);
+        displayEdges[(int)DisplaySpectrum::SCALE::LOG][i] = std::min(std::max((int)lrintf(frequency / samplingRateOverSize), 1), maxTracks - 2);
     }
+    displayEdges[(int)DisplaySpectrum::SCALE::LINEAR][displayColumns] = maxTracks - 1;
+    displayEdges[(int)DisplaySpectrum::SCALE::LOG][displayColumns] = maxTracks - 1;
 }
 
 
 SinusoidalModel::~SinusoidalModel(){
+    if(pool != nullptr){//don't pull anything out from under a worker
+        pool->detach(job);
+    }
+    for(int b = 0; b < numResolutions; ++b){
+        if(resolutions[b].analysis != analysis){//their arrays are in the arena, like ours
+            delete resolutions[b].analysis;
+        }
+    }
     delete analysis;
     delete wavetable;
-    delete[] tracks;
-    delete[] oscillators;
-	delete[] detected;
-    delete[] matches;
-    delete[] magnitudeThresholds;
-    delete[] frequencyThresholds;
-    delete[] peakThresholds;
-	delete[] candidates;
+    delete synthesis;
+	delete frames;
+	delete display;
+	delete[] displayEdges[0];
+	delete[] displayEdges[1];
+    delete arena;//every per-hop array, ours and the analysis'
+}
+
+void SinusoidalModel::carve(Arena &a){
+    //the order breakpoint() goes through them: capture, fft and spectra, then detect, match, birth and update
+    history = bassHistory = nullptr;
+    decimationBuffer = nullptr;
+    if(numResolutions > 1){//the bass band's window is 4x ours, before decimation
+        history = a.make<RingBuffer<float>>(a.take<float>(windowSize * 4), windowSize * 4);
+        decimationBuffer = a.take<float>(windowSize * 4);
+        bassHistory = a.make<RingBuffer<float>>(a.take<float>(windowSize), windowSize);
+    }
+    analysis->carve(a);
+    magnitudeThresholds = a.take<float>(maxTracks);
+    for(int b = 0; b < numResolutions; ++b){
+        if(resolutions[b].analysis != analysis){
+            resolutions[b].analysis->carve(a);
+            resolutions[b].magnitudeThresholds = a.take<float>(resolutions[b].analysis->getNumBins());
+        }
+    }
+	peaks = a.take<Peak>(maxTracks / 2 + 1);//local maxima are at least 3 bins apart
+    matches = a.take<bool>(maxTracks);
+    tracks.carve(a, maxTracks);
+	candidates = a.take<TrackMatch>(maxTracks);
+    frequencyThresholds = a.take<float>(maxFreq);
+	events = a.take<Frame::EVENT>(maxTracks);
+    residualSpectrum = a.take<float>(maxTracks);
+    residualLobe = a.take<float>((int)(residualLobeWidth * RESIDUALLOBEOVERSAMPLING) + 2);
+    bandEdges = a.take<int>(RESIDUALBANDS + 1);
+    residualBands = a.take<float>(RESIDUALBANDS);
+}
+
+void SinusoidalModel::planResolutions(const Analysis::WINDOW w, const int r, const float sr, const bool p){
+    int b, size, hop = analysis->getHopSize();
+    numResolutions = std::min(std::max(r, 1), MAXRESOLUTIONS);
+    for(b = 0; b < numResolutions; ++b){
+        if(numResolutions == 1 || b == 1){
+            resolutions[b].analysis = analysis;
+        }
+        else if(b == 0){//the long window at a quarter of the rate, as many points as ours and the same hop
+            resolutions[b].analysis = new Analysis(w, windowSize, windowSize / hop * BASSDECIMATION, sr / BASSDECIMATION, p, false);
+        }
+        else{//a quarter of ours, but no shorter than a hop
+            size = std::max(windowSize / 4, hop);
+            resolutions[b].analysis = new Analysis(w, size, size / hop, sr, p, false);
+        }
+    }
+}
+
+void SinusoidalModel::prepareResolutions(const float sr){
+    int b, i, numBins, sizes[MAXRESOLUTIONS];
+    float width, * frequencies, splits[MAXRESOLUTIONS + 1];
+    undecimated = 0;
+    if(numResolutions == 1){//just ours, over the whole spectrum, captured the usual way
+        resolutions[0] = {analysis, magnitudeThresholds, sr, 2, maxTracks - 2, 0, 0.0f, nullptr};
+        return;
+    }
+    //bass from a window 4x ours, then ours, then (with three) the short one
+    sizes[0] = windowSize * 4;
+    sizes[1] = windowSize;
+    sizes[2] = (numResolutions == 3)?resolutions[2].analysis->getWindowSize():0;
+    splits[0] = 0.0f;
+    splits[1] = RESOLUTIONSPLITLOW;
+    splits[2] = (numResolutions == 3)?RESOLUTIONSPLITHIGH:sr;
+    splits[3] = sr;
+    for(b = 0; b < numResolutions; ++b){
+        Resolution &res = resolutions[b];
+        if(b == 1){
+            res.magnitudeThresholds = magnitudeThresholds;
+        }
+        else{
+            res.analysis->prepare();
+            numBins = res.analysis->getNumBins();
+            frequencies = &res.analysis->getFrequencies();
+            for(i = 0; i < numBins; ++i){
+                res.magnitudeThresholds[i] = 20.0 * log10f(1.0 / (magThresholdFactor * frequencies[i]) + CRUMB);
+            }
+        }
+        numBins = res.analysis->getNumBins();
+        width = res.analysis->getSamplingRateOverSize();
+        res.high = splits[b + 1];
+        res.first = std::max((int)(splits[b] / width) - 1, 2);
+        res.last = std::min((int)(res.high / width) + 3, numBins - 2);
+        //decimate() centres the newest bass sample BASSDECIMATION - 1 back, and with no delay of its own that puts
+        //the bass window's centre exactly where the others' is
+        res.delay = (b == 0)?0:(sizes[0] - sizes[b]) / 2;
+        res.phaseOffset = (sizes[b] - windowSize) / (2.0f * sr);
+        res.input = (b == 0)?bassHistory:history;
+    }
+}
+
+void SinusoidalModel::prepareResidual(){
+    const float * window = analysis->getWindow();
+    int i, n, b, paddedSize = 2 * (maxTracks - 1), numPoints = (int)(residualLobeWidth * RESIDUALLOBEOVERSAMPLING) + 2;
+    double sum = 0.0, sumSq = 0.0, re, im, rotRe, rotIm, phRe, phIm, t;
+    for(n = 0; n < windowSize; ++n){
+        sum += window[n];
+        sumSq += window[n] * window[n];
+    }
+    //|W(delta)| / W(0) for delta in bins of the padded FFT, summed with a rotating phasor rather than a sin/cos per term
+    for(i = 0; i < numPoints; ++i){
+        rotRe = cos(2.0 * M_PI * i / (RESIDUALLOBEOVERSAMPLING * paddedSize));
+        rotIm = -sin(2.0 * M_PI * i / (RESIDUALLOBEOVERSAMPLING * paddedSize));
+        phRe = 1.0;
+        phIm = re = im = 0.0;
+        for(n = 0; n < windowSize; ++n){
+            re += window[n] * phRe;
+            im += window[n] * phIm;
+            t = phRe * rotRe - phIm * rotIm;
+            phIm = phRe * rotIm + phIm * rotRe;
+            phRe = t;
+        }
+        residualLobe[i] = (float)(sqrt(re * re + im * im) / sum);
+    }
+    for(b = 0; b < RESIDUALBANDS; ++b){
+        bandEdges[b] = std::min(std::max((int)ceilf(residual::edges[b] / samplingRateOverSize), 1), maxTracks - 1);
+    }
+    bandEdges[RESIDUALBANDS] = maxTracks - 1;
+    //white noise with variance s^2 has E|X|^2 = s^2 * sum(w^2) in every bin, and a density of 2 s^2 / sr per Hz.
+    //amplitudes are 2|X| / (numBins - 1), so this takes a band's rms amplitude to sqrt(density)
+    residualScale = (float)(0.5 * (maxTracks - 1) * sqrt(2.0 / (samplingRateOverSize * paddedSize * sumSq)));
 }
 
 //getters
@@ -113,227 +260,534 @@ float * SinusoidalModel::getAnalysisResults(const Analysis::PARAMETER p) const{
     }
 }
 float SinusoidalModel::getAmpNormFactor() const{
-	return analysis->getNormFactor();
+	return analysis->getAmpNormFactor();
+}
+int SinusoidalModel::getHopSize() const{
+	return analysis->getHopSize();
 }
 //setters
 void SinusoidalModel::setWaveform(Wavetable<float>::WAVEFORM wf){
     wavetable->setWaveform(wf, false);
 }
 
+void SinusoidalModel::setPrecision(const Analysis::PRECISION p){
+    for(int b = 0; b < numResolutions; ++b){
+        resolutions[b].analysis->setPrecision(p);
+    }
+}
+
+void SinusoidalModel::setEstimator(const Analysis::ESTIMATOR e){
+    for(int b = 0; b < numResolutions; ++b){
+        resolutions[b].analysis->setEstimator(e);
+    }
+}
+
+void SinusoidalModel::updateAnalysisResults(const Analysis::PARAMETER p){
+    if(pool != nullptr && (threaded || pool->isBusy(job))){//a worker may own the analysis, let it do this after the next hop
+        requested.fetch_or(1 << (int)p);
+        return;
+    }
+    analysis->update(p);
+}
+
+void SinusoidalModel::updateDisplay(){
+    if(display->isPending()){//nobody's looking, or they haven't caught up. either way it can wait
+        return;
+    }
+    if(pool != nullptr && (threaded || pool->isBusy(job))){
+        requested.fetch_or(DISPLAYREQUEST);
+        return;
+    }
+    publishDisplay();
+}
+
+void SinusoidalModel::publishDisplay(){
+    DisplaySpectrum * d = display->write();
+    analysis->update(Analysis::PARAMETER::AMP);
+    d->scale = displayScale.load(std::memory_order_relaxed);
+    d->reduction = displayReduction.load(std::memory_order_relaxed);
+    d->numColumns = displayColumns;
+    d->low = (d->scale == DisplaySpectrum::SCALE::LOG)?SPECTRUMDISPLAYLOW:0.0f;
+    d->high = samplingRateOverSize * (maxTracks - 1);
+    kernels.reduce(&analysis->getAmplitudes(), displayEdges[(int)d->scale], d->amplitudes, displayColumns,
+                   analysis->getAmpNormFactor(), d->reduction == DisplaySpectrum::REDUCTION::MEAN);
+    display->publish();
+}
+
+void SinusoidalModel::setDisplayMode(const DisplaySpectrum::SCALE s, const DisplaySpectrum::REDUCTION r){
+    displayScale.store(s, std::memory_order_relaxed);
+    displayReduction.store(r, std::memory_order_relaxed);
+}
+
+void SinusoidalModel::setResidual(const float level){
+    residual.store(level > 0.0f, std::memory_order_relaxed);//picked up by the next breakpoint(), wherever it runs
+    synthesis->setResidualLevel(level);
+}
+
+void SinusoidalModel::setAnalysisPool(AnalysisPool * p){
+    pool = p;
+    job = pool->attach(this);
+    if(job < 0){
+        pool = nullptr;
+    }
+}
+
 
 //business/helper functions
 void SinusoidalModel::init(){
     
+    if(pool != nullptr){//drop whatever a worker was in the middle of
+        pool->wait(job);
+        pool->collect(job);
+    }
+    //a reused model mustn't analyze what it was fed before it was retired
+    for(int b = 0; b < numResolutions; ++b){
+        resolutions[b].analysis->init();
+    }
+    if(history != nullptr){
+        history->clear();
+        bassHistory->clear();
+        undecimated = 0;
+    }
     activeTracks = 0;
+    frames->clear();
+    synthesis->reset();
+    droppedHops = droppedFrames = hopCount = 0;
+    std::fill(events, events + maxTracks, Frame::EVENT::NONE);
     //hard coding these for now
-    trackBirth = 0;
-    trackDeath = 10;
-    
+    tracks.setLifetimes(0, 10);
+    tracks.reset();//births take the lowest dead track idx first
     srand(time(0));
 }
 
 bool SinusoidalModel::operator() (const float sample){//use this to write samples to the input buffer
+    if(history != nullptr){
+        history->write(sample);
+        undecimated++;
+    }
     return analysis->operator()(sample) ;
 }
 
 float SinusoidalModel::operator() (void){//use this to read samples from the oscillators
-    float out = 0.0;
-	int numChecked = 0;
-	if(activeTracks == 0){
-		std::cout << "no active tracks" << std::endl;
-		return out;
-	}
-    for(int i = 0; i < maxTracks; ++i){//get output from active tracks
-        if(tracks[i].active){
-            out += oscillators[i].next() * logf(tracks[i].aliveFrames) * fadeFactor;
-			numChecked++;
-			if(numChecked == activeTracks){
-				break;
-			}
+    float out;
+    synthesize(&out, 1);
+    return out;
+}
+
+void SinusoidalModel::synthesize(float * out, const int numSamples){
+    synthesis->render(out, numSamples);
+}
+
+int SinusoidalModel::process(const float * in, float * out, const int numSamples){
+    int segment, numHops = 0;
+    for(int i = 0; i < numSamples; i += segment){
+        //run up to the next hop boundary (or the end of the block)
+        segment = std::min(analysis->getSamplesUntilFFT(), numSamples - i);
+        //input goes in first since in and out are allowed to be the same buffer
+        if(history != nullptr){
+            history->write(in + i, segment);
+            undecimated += segment;
+        }
+        if(analysis->write(in + i, segment)){
+            synthesize(out + i, segment);
+            hop();
+            numHops++;
+        }
+        else{
+            synthesize(out + i, segment);
+        }
+    }
+    return numHops;
+}
+
+void SinusoidalModel::hop(){
+    //threaded: the frame a worker finished during the last hop takes over from here, one hop late
+    if(pool != nullptr){
+        pool->collect(job);
+        synthesis->consume(*frames);
+    }
+    if(pool != nullptr && pool->isBusy(job)){//the worker fell behind, keep rendering what we have and skip this hop's analysis
+        analysis->discard();
+        if(history != nullptr){//or the bass band would have a hop missing from the middle of its window
+            decimate();
         }
+        droppedHops++;
+        instrumentation::count(instrumentation::local(), instrumentation::COUNTER::DROPPEDHOPS);
+    }
+    else if(pool != nullptr && threaded){
+        capture();//the input buffer belongs to the audio thread, so the copy happens here
+        pool->submit(job);
+    }
+    else{
+        transform(Analysis::TRANSFORM::FFT);
+        breakpoint();
+        synthesis->consume(*frames);
     }
+}
 
-//	out /= (float)activeTracks; /**/ //
-										   //out /= analysis->getAmplitudeNormalizationFactor();
-	//std::cout << activeTracks << " active tracks, output amp: " << out << std::endl;
-	//std::cout << "numActive: " << activeTracks << std::endl;
-//    return 2 * out;// / analysis->getAmplitudeNormalizationFactor();//(float)activeTracks;
-	return out * analysis->getDenormFactor() / (float)activeTracks;
+void SinusoidalModel::analyze(){
+    int r;
+    execute();
+    breakpoint();
+    r = requested.exchange(0);
+    for(int p = (int)Analysis::PARAMETER::AMP; p <= (int)Analysis::PARAMETER::PHS; ++p){
+        if(r & (1 << p)){
+            analysis->update((Analysis::PARAMETER)p);
+        }
+    }
+    if(r & DISPLAYREQUEST){
+        publishDisplay();
+    }
 }
 
 void SinusoidalModel::transform(const Analysis::TRANSFORM t){
-    analysis->transform(t);
+    if(t == Analysis::TRANSFORM::FFT){
+        capture();
+        execute();
+    }
+    else{
+        analysis->transform(t);
+    }
 }
 
-void SinusoidalModel::interpolatePeak(const int pIdx, const float ml, const float m, const float mr,
-									const float pL, const float p, const float pR, float &pm, float &pf, float &pp){
-	float idxOffset, diff, idx, frac;
-	diff = (ml - mr);
-	idxOffset = 0.5 * diff / (ml + mr - 2.0 * m);
-	pm = m - 0.25 * diff * idxOffset;
-	idx = pIdx + idxOffset;
-	pf = idx * samplingRateOverSize;
+void SinusoidalModel::capture(){
+    if(history == nullptr){
+        analysis->capture();
+        return;
+    }
+    decimate();
+    for(int b = 0; b < numResolutions; ++b){
+        resolutions[b].analysis->capture(*resolutions[b].input, resolutions[b].delay);
+    }
+}
+
+//triangle lowpass, two BASSDECIMATION point boxcars in a row: its nulls sit on every multiple of the decimated rate,
+//where the aliases would land, and it droops a few hundredths of a dB by the top of the bass band
+void SinusoidalModel::decimate(){
+    const int reach = 2 * BASSDECIMATION - 2;//samples before the first output's centre and after the last one's
+    int i, j, n = std::min(undecimated, windowSize * BASSDECIMATION - reach) / BASSDECIMATION;
+    float sum;
+    undecimated %= BASSDECIMATION;
+    if(n == 0){
+        return;
+    }
+    //n outputs BASSDECIMATION apart need (n - 1) * BASSDECIMATION + reach + 1 inputs, so the newest one is centred
+    //BASSDECIMATION - 1 behind the newest input the lowpass has seen
+    history->latest(decimationBuffer, (n - 1) * BASSDECIMATION + reach + 1, undecimated);
+    for(i = 0; i < n; ++i){//in place, each output lands at or before the first input it reads
+        sum = 0.0f;
+        for(j = 0; j <= reach; ++j){
+            sum += std::min(j + 1, reach + 1 - j) * decimationBuffer[i * BASSDECIMATION + j];
+        }
+        decimationBuffer[i] = sum / (BASSDECIMATION * BASSDECIMATION);
+    }
+    bassHistory->write(decimationBuffer, n);
+}
+
+void SinusoidalModel::execute(){
+    for(int b = 0; b < numResolutions; ++b){
+        resolutions[b].analysis->execute();
+    }
+}
+
+float SinusoidalModel::interpolatePhase(const float idx, const int pIdx, const float pL, const float p, const float pR) const{
+	float frac;
 	if(idx <= pIdx){
 		frac = idx - pIdx + 1;
-		pp = (1.0 - frac) * pL + frac * p;
-	}
-	else{
-		frac = idx - pIdx;
-		pp = frac * p + (1.0 - frac) * pR;
+		return (1.0 - frac) * pL + frac * p;
 	}
+	frac = idx - pIdx;
+	return (1.0 - frac) * p + frac * pR;
+}
+
+void SinusoidalModel::interpolatePeak(const Analysis &a, const int pIdx, const float ml, const float m, const float mr,
+									const float pL, const float p, const float pR, float &pm, float &pf, float &pp){
+	float idxOffset, diff, idx, bias;
+	diff = (ml - mr);
+	a.getWindowTable().correct(0.5 * diff / (ml + mr - 2.0 * m), idxOffset, bias);//the window's own parabola bias taken out
+	pm = m - 0.25 * diff * idxOffset + bias;
+	idx = pIdx + idxOffset;
+	pf = idx * a.getSamplingRateOverSize();
+	pp = interpolatePhase(idx, pIdx, pL, p, pR);
 }
 
-void SinusoidalModel::interpolatePeak(const int pIdx, const float ml, const float m, const float mr,
+void SinusoidalModel::reassignPeak(const Analysis &a, const int pIdx, const float m, const float pL, const float p, const float pR,
+								   float &pm, float &pf, float &pp){
+	float idxOffset, idx;
+	idxOffset = std::min(std::max(a.getFrequencyOffset(pIdx), -1.0f), 1.0f);//anything further out isn't a sinusoid anyway
+	pm = m - 20.0 * log10f(a.getWindowTable().getLobeGain(idxOffset) + CRUMB);//the bin only caught part of the main lobe
+	idx = pIdx + idxOffset;
+	pf = idx * a.getSamplingRateOverSize();
+	pp = interpolatePhase(idx, pIdx, pL, p, pR);
+}
+
+void SinusoidalModel::interpolatePeak(const Analysis &a, const int pIdx, const float ml, const float m, const float mr,
 									  float &pm, float &pf){
-	float idxOffset, diff;
+	float idxOffset, diff, bias;
 	diff = (ml - mr);
-	idxOffset = 0.5 * diff / (ml + mr - 2.0 * m);
-	pm = m - 0.25 * diff * idxOffset;
-	pf = (pIdx + idxOffset) * samplingRateOverSize;
+	a.getWindowTable().correct(0.5 * diff / (ml + mr - 2.0 * m), idxOffset, bias);
+	pm = m - 0.25 * diff * idxOffset + bias;
+	pf = (pIdx + idxOffset) * a.getSamplingRateOverSize();
 }
 
 void SinusoidalModel::breakpoint(){
-    hopSize = analysis->getAppetite();
-    float * magnitudes = &analysis->getMagnitudes();
-    float * frequencies = &analysis->getFrequencies();
-    float * phases = &analysis->getPhases();
-    float mag, magL, magLL, magLDiff, magR, magRR, magRDiff, phs, phsL, phsR, frq, frqL, frqR,
-    peakAmp, peakMag, peakPhs, peakFrq, lookupAmp, lookupFrq, lookupPhs,
-	frqDiff, magThreshold, frqThreshold, peakThreshold, ampScale = analysis->getNormFactor();
-    int i, j, numNewTracks = 0, deadIdx, maxTracksMinusOne = maxTracks - 1;
-	bool matched;
+    instrumentation::Slot * slot = instrumentation::local();
+    int dropped = droppedFrames;
+    beginHop();
+    {
+        instrumentation::ScopedTimer timer(slot, instrumentation::STAGE::DETECT);//includes deriving magnitudes
+        detectPeaks();
+    }
+    {
+        instrumentation::ScopedTimer timer(slot, instrumentation::STAGE::MATCH);
+        matchPeaks();
+    }
+    {
+        instrumentation::ScopedTimer timer(slot, instrumentation::STAGE::BIRTH);
+        birthTracks();
+    }
+    {
+        instrumentation::ScopedTimer timer(slot, instrumentation::STAGE::RESIDUAL);
+        estimateResidual();
+    }
+    {
+        instrumentation::ScopedTimer timer(slot, instrumentation::STAGE::UPDATE);
+        updateTracks();
+    }
+    if(slot != nullptr){
+        slot->add(instrumentation::COUNTER::PEAKS, numPeaks);
+        slot->add(instrumentation::COUNTER::SIDELOBES, numSidelobes);
+        slot->add(instrumentation::COUNTER::BORN, numBorn);
+        slot->add(instrumentation::COUNTER::KILLED, numKilled);
+        slot->add(instrumentation::COUNTER::STOLEN, numStolen);
+        slot->add(instrumentation::COUNTER::ACTIVETRACKS, activeTracks);
+        slot->max(instrumentation::COUNTER::MAXACTIVETRACKS, activeTracks);
+        slot->add(instrumentation::COUNTER::DROPPEDFRAMES, droppedFrames - dropped);
+    }
+}
+
+void SinusoidalModel::beginHop(){
+    hopSize = analysis->getHopSize();
     memset(matches, false, sizeof(bool) * maxTracks);
-    for(i = 2; i < maxTracksMinusOne; ++i){//loop over frq bins
-		detected[i].reset();
-		magThreshold = magnitudeThresholds[i];//pick threshold according to frequency range
+    numBorn = numKilled = numStolen = numSidelobes = 0;
+}
+
+void SinusoidalModel::detectPeaks(){//fills peaks[] in ascending frequency order
+    Analysis * a;
+    numPeaks = 0;
+    if(!(analysis->getDenormFactor() > 0.0f)){//our frame is silent, nothing to normalize by
+        return;
+    }
+    for(int b = 0; b < numResolutions; ++b){
+        //a band's magnitudes are normalized by its own frame. undone here, so every peak carries the amplitude
+        //of the sinusoid itself, whatever band it came from and however loud the rest of the frame is
+        a = resolutions[b].analysis;
+        detectPeaks(resolutions[b], a->getDenormFactor() * a->getSineGain());
+    }
+}
+
+void SinusoidalModel::detectPeaks(const Resolution &r, const float ampScale){
+    Analysis * a = r.analysis;
+    a->update(Analysis::PARAMETER::MAG);//phases are only looked up around the peaks
+    float * magnitudes = &a->getMagnitudes();
+    float mag, magL, magLL, magLDiff, magR, magRR, magRDiff, phs, phsL, phsR,
+    peakAmp, peakMag, peakPhs, peakFrq, magThreshold, peakThreshold, binWidth = a->getSamplingRateOverSize(), lowest = 0.0f;
+    int i, first = numPeaks, capacity = maxTracks / 2 + 1;
+    //a sinusoid's farther neighbour is at least a bin down the main lobe, whatever its offset. anything flatter isn't one
+    peakThreshold = PEAKSHAPEFRACTION * (1.0f / a->getWindowTable().getLobeGain(1.0f) - 1.0f);
+    if(numPeaks > 0){//whatever the band below already caught near the split, its longer window resolved better
+        lowest = peaks[numPeaks - 1].frq + 2.0f * binWidth;
+    }
+    for(i = r.first; i < r.last && numPeaks < capacity; ++i){//loop over frq bins, leaving two either side for the neighbours
+		magThreshold = r.magnitudeThresholds[i];//pick threshold according to frequency range
 		magLL = magnitudes[i-2];
 		magL = magnitudes[i-1];
         mag = magnitudes[i];
         magR = magnitudes[i+1];
 		magRR = magnitudes[i+2];
         if(mag > magThreshold && magLL < magL && magL < mag && mag > magR && magR > magRR){//at local max
-			peakThreshold = peakThresholds[(int)frequencies[i]];
-            frqL = frequencies[i-1];
-            frq = frequencies[i];
-            frqR = frequencies[i+1];
-			phsL = phases[i-1];
-            phs = phases[i];
-			phsR = phases[i+1];
-
-            //quadratically interpolate peak
-            //std::cout << "interpolating mags {" << magL << ", " << mag << ", " << magR << "} and frqs {" <<
-            //frqL << ", " << frq << ", " << frqR << "}" << std::endl;
-            //interpolatePeak(i, magL, mag, magR, peakMag, peakFrq);
-			interpolatePeak(i, magL, mag, magR, phsL, phs, phsR, peakMag, peakFrq, peakPhs);
-			//std::cout << "mag comparison: " << magL << ", " << mag << ", " << magR << std::endl;
+			phsL = a->getPhase(i-1);
+            phs = a->getPhase(i);
+			phsR = a->getPhase(i+1);
+
+            //quadratically interpolate peak, or read its frequency straight off the reassignment
+			if(a->isReassigned()){
+				reassignPeak(*a, i, mag, phsL, phs, phsR, peakMag, peakFrq, peakPhs);
+			}
+			else{
+				interpolatePeak(*a, i, magL, mag, magR, phsL, phs, phsR, peakMag, peakFrq, peakPhs);
+			}
+			if(peakFrq < lowest || peakFrq >= r.high){//another band's
+				continue;
+			}
+			if(r.phaseOffset != 0.0f){//advance to where our window starts, so every band's phases agree
+				peakPhs += peakFrq * r.phaseOffset;
+				peakPhs -= floorf(peakPhs);
+			}
 			//std::cout << "interped mag: " << peakMag << std::endl;
-			//std::cout << "frq comparison: " << frqL << ", " << frq << ", " << frqR << std::endl;
 			//std::cout << "interped frq: " << peakFrq << std::endl;
-			//std::cout << "phs comparison: " << phsL << ", " << phs << ", " << phsR << std::endl;
 			//std::cout << "interped phs: " << peakPhs << std::endl;
 			magLDiff = powf(10.0, (peakMag - magL) * ONEOVERTWENTY) - 1.0;//percentage difference from peak
 			magRDiff = powf(10.0, (peakMag - magR) * ONEOVERTWENTY) - 1.0;//percentage difference from peak
 			if(magLDiff > peakThreshold || magRDiff > peakThreshold){
-//				std::cout << "magLDiff: " << magLDiff << ", magRDiff: " << magRDiff << std::endl;
 	            peakAmp = powf(10.0, peakMag * ONEOVERTWENTY) * ampScale;
-        	    //peakPhs = phs;
         	    //std::cout << "Peak " << i << " detected. Frq: " << peakFrq << " Amp: "<< peakAmp << " Mag: " << peakMag << " Phs: " << peakPhs << std::endl;
-				detected[i].init(i, true, peakAmp, peakFrq, peakPhs);
-				numNewTracks++;
+				peaks[numPeaks++].init(i, peakAmp, peakFrq, peakPhs);
 			}
         }
     }
+    suppressSidelobes(first, a->getWindowTable(), binWidth);
+}
+
+void SinusoidalModel::suppressSidelobes(const int first, const windows::Table &t, const float binWidth){
+    //a peak this close to a louder one, and no louder than that one's sidelobes (give or take), is taken for one of them
+    float ratio = powf(10.0f, (t.sidelobeLevel + SIDELOBEMARGIN) * ONEOVERTWENTY), reach = SIDELOBEREACH * t.mainLobeWidth * binWidth, amp;
+    int i, j, n;
+    for(i = first; i < numPeaks; ++i){//marked by negating their amplitude, so every test sees the original list
+        amp = fabsf(peaks[i].amp);
+        for(j = i - 1; j >= first && peaks[i].frq - peaks[j].frq < reach && peaks[i].amp > 0.0f; --j){
+            if(fabsf(peaks[j].amp) * ratio >= amp){
+                peaks[i].amp = -amp;
+            }
+        }
+        for(j = i + 1; j < numPeaks && peaks[j].frq - peaks[i].frq < reach && peaks[i].amp > 0.0f; ++j){
+            if(fabsf(peaks[j].amp) * ratio >= amp){
+                peaks[i].amp = -amp;
+            }
+        }
+    }
+    for(i = n = first; i < numPeaks; ++i){
+        if(peaks[i].amp > 0.0f){
+            peaks[n++] = peaks[i];
+        }
+    }
+    numSidelobes += numPeaks - n;
+    numPeaks = n;
+}
+
+void SinusoidalModel::matchPeaks(){
+    int i, j, k, numLive = tracks.getNumLive();
 	//attempt to match detected peaks to existing tracks
-	for(j = 0; j < maxTracks; ++j){//looping over tracks
-		if(tracks[j].status != Track::STATUS::DEAD){//only attempt to match to living or limbo tracks
-			candidates[j].reset();
-			lookupAmp = tracks[j].amp;
-			lookupFrq = tracks[j].frq;
-			lookupPhs = tracks[j].phs;
-			for(i = 1; i < maxTracksMinusOne; ++i){//looping over detections
-				if(detected[i].detected){
-					frqThreshold = frequencyThresholds[(int)lookupFrq];
-					frqDiff = fabs(lookupFrq - detected[i].frq);//need abs for comparisons
-					if(frqDiff < frqThreshold){//potential match here
-						//test against current best match
-						detected[i].setDistanceSq(lookupAmp, lookupFrq, lookupPhs);
-						if(matchSort(detected[i], candidates[j])){
-							candidates[j] = detected[i];
-						}
-					}
-				}
-			}
-		}
-	}
-//	std::cout << "num new before: " << numNewTracks << std::endl;
+	findCandidates(tracks, peaks, numPeaks, frequencyThresholds, candidates);
 	//now that all potential matches have been found for each track, let's assign the detected peaks
-	longestTrack = 1;
-	for(j = 0; j < maxTracks; ++j){//looping over tracks
-		if(tracks[j].status != Track::STATUS::DEAD){//only attempt to match to living or limbo tracks
-//			baseIdx = j * MATCHMATRIXDEPTH;
-			matched = false;
-			i = candidates[j].idx;
-			if(i > 0 && detected[i].detected && !detected[i].assigned){
-				matched = true;
-			}
-			if(matched){
-				peakAmp = detected[i].amp;
-				peakFrq = detected[i].frq;
-				peakPhs = detected[i].phs;
-				tracks[j].update(true, peakAmp, peakFrq, peakPhs);
-				oscillators[j].update(peakAmp, peakFrq, peakPhs, hopSize);
-				detected[i].assigned = true;
-				matches[j] = true;
-				numNewTracks--;
+	tracks.resetLongest();
+	numMatched = 0;
+	for(i = 0; i < numLive; ++i){//same tracks, same order, so lower tracks still get first pick
+		j = tracks.getLive(i);
+		k = candidates[j].idx;
+		if(k >= 0 && !peaks[k].assigned){
+			Peak &peak = peaks[k];
+			tracks.update(j, true, peak.amp, peak.frq, peak.phs);
+			if(events[j] == Frame::EVENT::NONE){//a START held over from a dropped frame still stands
+				events[j] = Frame::EVENT::UPDATE;
 			}
-				//std::cout << "Track " << j << " matched. Frq: " << peakFrq << " Mag: " << peakMag << " Phs: " << peakPhs << std::endl;
-				//std::cout << "Track " << j << " matched at frq " << peakFrq << ". Age: " << tracks[j].aliveFrames << std::endl;
+			peak.assigned = true;
+			matches[j] = true;
+			numMatched++;
 		}
+		//std::cout << "Track " << j << " matched at frq " << peakFrq << ". Age: " << tracks.getAliveFrames(j) << std::endl;
 	}
-	fadeFactor = 1.0 / (1.0 + logf(longestTrack));
-//	std::cout << "num new after: " << numNewTracks << std::endl;
+	//gains rise with the log of a track's age, up to 1 for the longest lived, so a steady partial comes back at its own level
+	fadeFactor = (tracks.getLongest() > 1)?1.0 / logf(tracks.getLongest()):0.0;
+}
+
+void SinusoidalModel::birthTracks(){
+    int k, deadIdx, numNewTracks = numPeaks - numMatched;
 	//check if we need to start new tracks for remaining peaks
-	for(i = 1; i < maxTracksMinusOne && numNewTracks > 0; ++i){//looping over detections
-		if(detected[i].detected && !detected[i].assigned){//find a dead track idx and start a new track
-			deadIdx = -1;
-			for(int j = 0; j < maxTracks; ++j){//looping over tracks
-				if(tracks[j].status == Track::STATUS::DEAD){
-					deadIdx = j;
-					break;
-				}
-			}
-			if(deadIdx == -1){//edge case, all tracks in use. randomly steal one
-				deadIdx = (rand() % maxTracksMinusOne);
+	for(k = 0; k < numPeaks && numNewTracks > 0; ++k){//looping over detections
+		Peak &peak = peaks[k];
+		if(!peak.assigned){//take the lowest free track idx and start a new track
+			if((deadIdx = tracks.birth()) < 0){//edge case, all tracks in use. randomly steal one
+				deadIdx = (rand() % (maxTracks - 1));
 				//std::cout << "stealing track " << deadIdx << " right meow" << std::endl;
-				tracks[deadIdx].status = Track::STATUS::DEAD;
+				tracks.restart(deadIdx);
+				numStolen++;
 			}
-			peakAmp = detected[i].amp;
-			peakFrq = detected[i].frq;
-			peakPhs = detected[i].phs;
-			//std::cout << "amp: " << peakAmp << ", frq: " << peakFrq << ", phs: " << peakPhs << std::endl;
-			
+			//std::cout << "amp: " << peak.amp << ", frq: " << peak.frq << ", phs: " << peak.phs << std::endl;
 			matches[deadIdx] = true;
-			tracks[deadIdx].init(this);
-			tracks[deadIdx].update(true, peakAmp, peakFrq, peakPhs);
-			oscillators[deadIdx].start(peakAmp, peakFrq, peakPhs);
+			tracks.update(deadIdx, true, peak.amp, peak.frq, peak.phs);
+			events[deadIdx] = Frame::EVENT::START;
 			numNewTracks--;
+			numBorn++;
 		}
 	}
-//	std::cout << "num new end: " << numNewTracks << std::endl;
+}
+
+void SinusoidalModel::estimateResidual(){
+    float * amplitudes;
+    float peakScale, centre, position, fraction, w, a, sum, lastPoint = residualLobeWidth * RESIDUALLOBEOVERSAMPLING;
+    float denormFactor = analysis->getDenormFactor();
+    int i, k, b, first, last;
+    if(!residual.load(std::memory_order_relaxed) || !(denormFactor > 0.0f)){//off, or a silent frame
+        std::fill(residualBands, residualBands + RESIDUALBANDS, 0.0f);
+        return;
+    }
+    analysis->update(Analysis::PARAMETER::AMP);
+    amplitudes = &analysis->getAmplitudes();
+    std::copy(amplitudes, amplitudes + maxTracks, residualSpectrum);
+    //take every peak's main lobe back out. magnitudes only: the partial and whatever is under it are assumed not
+    //to interfere, and anything that goes negative was all partial
+    peakScale = 1.0f / analysis->getSineGain();//a sinusoid's amplitude back to what its peak reads in amplitudes
+    for(k = 0; k < numPeaks; ++k){
+        a = peaks[k].amp * peakScale;
+        centre = peaks[k].frq / samplingRateOverSize;
+        first = std::max((int)ceilf(centre - residualLobeWidth), 1);
+        last = std::min((int)floorf(centre + residualLobeWidth), maxTracks - 2);
+        for(i = first; i <= last; ++i){
+            position = std::min(fabsf(i - centre) * RESIDUALLOBEOVERSAMPLING, lastPoint);
+            fraction = position - (int)position;
+            w = residualLobe[(int)position] + fraction * (residualLobe[(int)position + 1] - residualLobe[(int)position]);
+            residualSpectrum[i] = std::max(residualSpectrum[i] - a * w, 0.0f);
+        }
+    }
+    for(b = 0; b < RESIDUALBANDS; ++b){
+        sum = 0.0f;
+        for(i = bandEdges[b]; i < bandEdges[b + 1]; ++i){
+            sum += residualSpectrum[i] * residualSpectrum[i];
+        }
+        residualBands[b] = (bandEdges[b + 1] > bandEdges[b])?
+                           residualScale * sqrtf(sum / (bandEdges[b + 1] - bandEdges[b])) / denormFactor:0.0f;
+    }
+}
+
+void SinusoidalModel::updateTracks(){
+    Frame * frame = frames->write();
+    int i, j, numLive;
     activeTracks = 0;
-    for(j = 0; j < maxTracks; ++j){//looping over tracks
-        if(tracks[j].active){//do another pass to update active tracks that may have gone stale
+    if(frame != nullptr){
+        frame->numPartials = 0;
+        frame->hopSize = hopSize;
+        frame->index = hopCount;
+    }
+    hopCount++;
+    tracks.admit();//this hop's births join the live list. dead tracks have no events, so they can be skipped
+    numLive = tracks.getNumLive();
+    for(i = 0; i < numLive; ++i){//looping over living or limbo tracks, in ascending order
+        j = tracks.getLive(i);
+        if(tracks.isActive(j)){//do another pass to update active tracks that may have gone stale
             activeTracks++;
             if(!matches[j]){
-                tracks[j].update(false);
+                tracks.update(j, false);
+                numKilled += tracks.isDead(j);
             }
         }
+        if(frame != nullptr && (tracks.isActive(j) || events[j] != Frame::EVENT::NONE)){
+            frame->add(j, events[j], tracks.getStatus(j), tracks.getAmp(j), tracks.getFrq(j), tracks.getPhs(j),
+                       (tracks.isActive(j))?std::min(logf(tracks.getAliveFrames(j)) * fadeFactor, 1.0f):0.0f);
+        }
+    }
+    tracks.retire();//whatever died goes back on the heap for next hop's births, lowest idx first
+    if(frame == nullptr){//synthesis hasn't kept up. the events stay for the next frame, so no birth or ramp is lost
+        droppedFrames++;
+        return;
     }
+    frame->activeTracks = activeTracks;
+    frame->denormFactor = analysis->getDenormFactor();
+    std::copy(residualBands, residualBands + RESIDUALBANDS, frame->residual);
+    if(recorder != nullptr){//copied before the push, synthesis may start on it straight away
+        recorder->push(*frame);
+    }
+    frames->push();
+    std::fill(events, events + maxTracks, Frame::EVENT::NONE);
     //std::cout << "Synthesizing " << activeTracks << " of " << maxTracks << " possible tracks" << std::endl;
 }
-
-
-
-
-
-
@@ -13,14 +13,32 @@
 
 #include "Analysis.h"
 #include "Oscillator.h"
+#include "SynthesisEngine.h"
 #include "Noise.h"
+#include "TripleBuffer.h"
+#include <atomic>
 #include <cassert>
 #include <ctime>
 
 #define MATCHMATRIXDEPTH 3
+#define FRAMEQUEUEDEPTH 4 //frames analysis can get ahead of synthesis by, power of two
+#define RESIDUALLOBEBINS 4 //unpadded bins either side of a peak taken out of the residual, covers every window's main lobe
+#define RESIDUALLOBEOVERSAMPLING 8 //residualLobe points per (padded) bin
+#define SPECTRUMDISPLAYBINS 512 //columns a display spectrum is reduced to, about what the editor has pixels for
+#define SPECTRUMDISPLAYLOW 20.0f //Hz, where a LOG display spectrum starts
+#define DISPLAYREQUEST (1 << 16) //requested bit for updateDisplay(), clear of the Analysis::PARAMETER bits
+#define PEAKSHAPEFRACTION 0.5f //of the window's main lobe fall one bin out, a peak's farther neighbour has to fall
+#define SIDELOBEMARGIN 6.0f //dB above a louder peak's sidelobe level a quieter one nearby is still taken for a sidelobe
+#define SIDELOBEREACH 4.0f //main lobe widths either side of a peak its sidelobes are looked for
+#define MAXRESOLUTIONS 3 //analyses a model can split the spectrum between, see Resolution
+#define RESOLUTIONSPLITLOW 300.0f //Hz, below this the long window's peaks are used
+#define RESOLUTIONSPLITHIGH 3000.0f //Hz, above this the short window's are, with three resolutions
+#define BASSDECIMATION 4 //the bass window is our length, over input lowpassed and kept every this many samples
 
-class Track;
 class TrackMatch;
+class Peak;
+class AnalysisPool;
+class PartialWriter;
 enum class ThresholdFunction{
 	oneOverX,
 	logX,
@@ -28,31 +46,125 @@ enum class ThresholdFunction{
 	logXSqOverX
 };
 
+//the amplitude spectrum as the editor gets it: the loudest (or average) bin in each column, dc and nyquist
+//left out, normalized so 1 is the frame's loudest bin. LOG columns are log spaced from SPECTRUMDISPLAYLOW, and at the
+//low end several of them can share a bin
+struct DisplaySpectrum{
+    enum class SCALE{LINEAR, LOG};
+    enum class REDUCTION{MAX, MEAN};
+    float * amplitudes;
+    float low, high;//Hz, where the first column starts and the last one ends
+    int numColumns;//SPECTRUMDISPLAYBINS, or one per bin for small FFTs. 0 until something's been published
+    SCALE scale;
+    REDUCTION reduction;
+    DisplaySpectrum(const int capacity){
+        amplitudes = new float[capacity]();
+        low = high = 0.0f;
+        numColumns = 0;
+        scale = SCALE::LOG;
+        reduction = REDUCTION::MAX;
+    }
+    ~DisplaySpectrum(){
+        delete[] amplitudes;
+    }
+};
+
+//one band of a multi-resolution analysis. each has its own window length but they all hop together, so their
+//peaks merge into one frame. every window is centred on the same instant: the shorter ones are captured from
+//the model's history a little way back rather than from the newest input. the bass band's is decimated first,
+//so its long window costs no more to transform than ours
+struct Resolution{
+    Analysis * analysis;
+    float * magnitudeThresholds;//per bin of this analysis
+    float high;//Hz, peaks that interpolate past this are left to the next band
+    int first, last;//bins searched for peaks, last is one past. a little wider than the band, so nothing on a split is missed
+    int delay;//samples between the newest input and the end of this window
+    float phaseOffset;//seconds from this window's start to the model's own window's start
+    RingBuffer<float> * input;//what it's captured from, history or for the bass band its decimated copy
+};
+
 class SinusoidalModel{
-friend class Track;
 private:
+    Arena * arena;//one block for everything a hop touches, see carve()
     Analysis * analysis;
-    Track * tracks;
-    Oscillator<float> * oscillators;
+    TrackStore tracks;
+    SynthesisEngine * synthesis;
     Wavetable<float> * wavetable;
     bool * matches;
-    float * magnitudeThresholds, * frequencyThresholds, * peakThresholds;
-	TrackMatch * detected, * candidates;
+    float * magnitudeThresholds, * frequencyThresholds;
+	TrackMatch * candidates;
+	Peak * peaks;//this hop's detections, dense and in ascending frequency order
+	FrameQueue<Frame> * frames;//breakpoint() produces, synthesis consumes
+	Frame::EVENT * events;//what each track's oscillator has to do, since the last frame that was written
+	AnalysisPool * pool;
+	PartialWriter * recorder;//gets a copy of every frame, if set
+	TripleBuffer<DisplaySpectrum> * display;//produced wherever the analysis runs, consumed by the editor
+	int * displayEdges[2];//per SCALE, the first bin of each column plus one past the last
+	std::atomic<DisplaySpectrum::SCALE> displayScale;
+	std::atomic<DisplaySpectrum::REDUCTION> displayReduction;
+	spectrum::Kernels kernels;
+	Resolution resolutions[MAXRESOLUTIONS];//ascending frequency order, one of them is analysis
+	RingBuffer<float> * history;//the longest window's worth of input, only with more than one resolution
+	RingBuffer<float> * bassHistory;//history lowpassed and decimated by BASSDECIMATION, see decimate()
+	float * decimationBuffer;//history's undecimated tail plus the lowpass' reach, decimated in place
+	float * residualLobe;//window transform magnitude from 0 to residualLobeWidth bins out, 1 at 0
+	float * residualSpectrum, * residualBands;//amplitude spectrum minus the peaks' lobes, and its band levels
+	int * bandEdges;//first bin of each band, plus one past the last
+	std::atomic<int> requested;//analysis results asked for while a worker owns the analysis
+	std::atomic<bool> residual;
+	bool threaded;
 	
-    int windowSize, hopSize, maxTracks, activeTracks, trackBirth, trackDeath, longestTrack;
-    float magThresholdFactor, frqThresholdFactor, peakThresholdFactor, samplingRateOverSize, fadeFactor;
+    int numPeaks, numMatched, numResolutions, job, droppedHops, droppedFrames, hopCount;
+    int undecimated;//samples written to history since the last decimate()
+    int numBorn, numKilled, numStolen, numSidelobes;//this hop's track turnover and rejected peaks, for the instrumentation
+    int windowSize, hopSize, maxTracks, maxFreq, activeTracks, displayColumns;
+    float magThresholdFactor, frqThresholdFactor, samplingRateOverSize, fadeFactor;
+    float residualLobeWidth, residualScale;//lobe half width in bins, band rms amplitude to normalized density
 	ThresholdFunction freqThreshFnc, magThreshFnc;
-	
+
+    void carve(Arena &a);//lays out the analysis' arrays and ours, a measuring arena only counts them
+    void prepareResidual();//tabulate the window's transform, once the analysis has its window
+    void publishDisplay();//reduce this frame's amplitudes into the display's back slot and publish it
+    void planResolutions(const Analysis::WINDOW w, const int r, const float sr, const bool p);//each band's analysis, before carve()
+    void prepareResolutions(const float sr);//and the rest of the band plan once they're carved, see Resolution
+    void decimate();//brings bassHistory up to date with history
+    void capture();//every resolution's frame, on the thread that owns the input
+    void execute();//and their FFTs, wherever the analysis runs
+    void detectPeaks(const Resolution &r, const float ampScale);//one band's worth, appended to peaks[]
+    void suppressSidelobes(const int first, const windows::Table &t, const float binWidth);//from peaks[first] on
 public:
+    //r > 1 adds a window 4x as long for the bass, and with r = 3 a shorter one for the treble
     SinusoidalModel(const Analysis::WINDOW w, const int ws, const int hf, const float sr, const bool p,
-                    Wavetable<float>::WAVEFORM wf, const int wts);
+                    Wavetable<float>::WAVEFORM wf, const int wts, const int r = 1);
     ~SinusoidalModel();
     //getters
-    float * getAnalysisResults(const Analysis::PARAMETER p) const;
+    float * getAnalysisResults(const Analysis::PARAMETER p) const;//whatever was last derived, see updateAnalysisResults
 	float getAmpNormFactor() const;
+	int getHopSize() const;
+	int getMaxTracks() const{return maxTracks;}
+	int getNumResolutions() const{return numResolutions;}
+	int getAnalysisDelay() const{return resolutions[(numResolutions > 1)?1:0].delay;}//samples our window ends behind the newest input
+	int getSamplesUntilHop() const{return analysis->getSamplesUntilFFT();}
+	int getDroppedHops() const{return droppedHops;}
+	int getDroppedFrames() const{return droppedFrames;}
+	FrameQueue<Frame> & getFrames(){return *frames;}
+	SynthesisEngine & getSynthesis(){return *synthesis;}
+	bool isThreaded() const{return threaded;}
+	//the editor's side of the display channel, one thread only
+	bool refreshDisplay(){return display->update();}//true if getDisplay() has moved on to a newer spectrum
+	const DisplaySpectrum & getDisplay() const{return display->read();}
 
     //setters
     void setWaveform(Wavetable<float>::WAVEFORM wf);
+    void setPrecision(const Analysis::PRECISION p);
+    void setEstimator(const Analysis::ESTIMATOR e);//REASSIGNMENT does as well unpadded as PARABOLIC does padded
+    void updateAnalysisResults(const Analysis::PARAMETER p);//derive p for the current frame
+    void updateDisplay();//publish the current frame's spectrum, unless the editor hasn't taken the last one yet
+    void setDisplayMode(const DisplaySpectrum::SCALE s, const DisplaySpectrum::REDUCTION r);//from the next spectrum published
+    void setAnalysisPool(AnalysisPool * p);//not realtime safe, call before processing starts
+    void setRecorder(PartialWriter * w){recorder = w;}//before processing starts, nullptr to stop. frames synthesis dropped aren't recorded either
+    void setThreaded(const bool t){threaded = t;}//takes effect at the next hop the pool isn't busy with
+    void setResidual(const float level);//0 skips the residual analysis altogether, > 0 mixes its noise in at that level
     
     //business/helper functions
     void init();
@@ -60,13 +172,28 @@ public:
     
     bool operator() (const float sample);//use this to write samples to the input buffer
     float operator() (void);//use this to read samples from the output buffer
+    void synthesize(float * out, const int numSamples);//render a block from the synthesis engine
+    int process(const float * in, float * out, const int numSamples);//analyze & resynthesize a block, returns # of hops
+    void hop();//called by process() each time a full hop of input has been written
+    void analyze();//the half of hop() that runs on a pool worker in threaded mode
     void transform(const Analysis::TRANSFORM t);
-    void interpolatePeak(const int mIdx, const float ml, const float m, const float mr,
+    //parabolic, less the window's bias (see windows::Table::correct)
+    void interpolatePeak(const Analysis &a, const int mIdx, const float ml, const float m, const float mr,
 						 const float pL, const float p, const float pR, float &pm, float &pf, float &pp);
-    void interpolatePeak(const int mIdx, const float ml, const float m, const float mr,
+    void interpolatePeak(const Analysis &a, const int mIdx, const float ml, const float m, const float mr,
 						 float &pm, float &pf);
+    void reassignPeak(const Analysis &a, const int mIdx, const float m, const float pL, const float p, const float pR,
+					  float &pm, float &pf, float &pp);//for reassigned frames, the neighbours' magnitudes aren't needed
+    float interpolatePhase(const float idx, const int mIdx, const float pL, const float p, const float pR) const;//linear, between the two bins idx falls between
 	
     void breakpoint();
+    //breakpoint() stages, in the order they run
+    void beginHop();//clears last hop's matches
+    void detectPeaks();
+    void matchPeaks();
+    void birthTracks();
+    void estimateResidual();//subtracts this hop's peaks from the spectrum and fits the band envelope
+    void updateTracks();//also publishes this hop's Frame
 	int getNumActive(){ return activeTracks; };
 };
 
@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    SpectralSynthesis.cpp
+    Created: 17 Oct 2026 5:10:02am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "SpectralSynthesis.h"
+#include "FFTPlans.h"
+#include <cmath>
+#include <cstring>
+
+//4 term, -92 dB Blackman-Harris. its main lobe is exactly LOBEHALFWIDTH bins either side
+static const double blackmanHarris[4] = {0.35875, 0.48829, 0.14128, 0.01168};
+
+//transform of a length n rectangle centred on 0, at a fractional bin offset (real part)
+static double dirichlet(const double nu, const int n){
+    if(fabs(nu) < 1e-9){
+        return n;
+    }
+    return sin(M_PI * nu) * cos(M_PI * nu / n) / sin(M_PI * nu / n);
+}
+
+SpectralSynthesis::SpectralSynthesis(const float sr, const int n, const int hop){
+    int i, m, ringSize, lobeSize = 2 * LOBEHALFWIDTH * LOBEOVERSAMPLING + 1;
+    double nu, w, triangle;
+    samplingRate = sr;
+    size = n;
+    hopSize = hop;
+    fftSize = 4 * hopSize;
+    numBins = fftSize / 2 + 1;
+    limit = 0;
+    numReady = 0;
+    amplitude = new float[size]{0.0};
+    frequency = new float[size]{0.0};
+    lastFrequency = new float[size]{0.0};
+    phase = new float[size]{0.0};
+    gain = new float[size]{0.0};
+    active = new bool[size]{false};
+
+    //a Blackman-Harris window is a sum of cosines, so its transform is the same sum of shifted Dirichlet kernels
+    lobe = new float[lobeSize];
+    for(i = 0; i < lobeSize; ++i){
+        nu = (double)i / LOBEOVERSAMPLING - LOBEHALFWIDTH;
+        w = blackmanHarris[0] * dirichlet(nu, fftSize);
+        for(m = 1; m < 4; ++m){
+            w += 0.5 * blackmanHarris[m] * (dirichlet(nu - m, fftSize) + dirichlet(nu + m, fftSize));
+        }
+        lobe[i] = (float)w;
+    }
+    //undo the Blackman-Harris window (and the fft's gain of fftSize) in the middle two hops, where it is
+    //comfortably away from zero, and put a triangle in its place
+    grainWindow = new float[2 * hopSize];
+    for(i = -hopSize; i < hopSize; ++i){
+        w = 0.0;
+        for(m = 0; m < 4; ++m){
+            w += blackmanHarris[m] * cos(2.0 * M_PI * m * i / fftSize);
+        }
+        triangle = 1.0 - fabs((double)i) / hopSize;
+        grainWindow[i + hopSize] = (float)(triangle / (w * fftSize));
+    }
+    grain = new float[2 * hopSize];
+    for(ringSize = 1; ringSize < fftSize; ringSize <<= 1){
+        ;
+    }
+    outputBuffer = new RingBuffer<float>(ringSize);
+
+    //FFTW, same setup as Analysis' backward plan
+    realBuffer = (float*) fftwf_malloc(sizeof(float) * fftSize);
+    complexBuffer = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * numBins);
+    backwardPlan = fftplans::acquire(fftSize, fftplans::DIRECTION::BACKWARD, realBuffer, complexBuffer);
+    memset(realBuffer, 0, sizeof(float) * fftSize);
+    memset(complexBuffer, 0, sizeof(fftwf_complex) * numBins);
+}
+
+SpectralSynthesis::~SpectralSynthesis(){
+    delete[] amplitude;
+    delete[] frequency;
+    delete[] lastFrequency;
+    delete[] phase;
+    delete[] gain;
+    delete[] active;
+    delete[] lobe;
+    delete[] grainWindow;
+    delete[] grain;
+    delete outputBuffer;
+    fftplans::release(backwardPlan);
+    fftwf_free(realBuffer);
+    fftwf_free(complexBuffer);
+}
+
+void SpectralSynthesis::start(const int i, const float a, const float f, const float /*p*/){//phase is integrated, as in the bank
+    amplitude[i] = a;
+    frequency[i] = lastFrequency[i] = f;
+    phase[i] = 0.0;
+}
+
+void SpectralSynthesis::update(const int i, const float a, const float f, const float /*p*/, const int /*d*/){
+    amplitude[i] = a;
+    frequency[i] = f;
+}
+
+void SpectralSynthesis::stop(const int i){
+    amplitude[i] = 0.0;
+}
+
+void SpectralSynthesis::setActive(const int i, const bool a){
+    active[i] = a;
+    if(a){
+        if(i >= limit){
+            limit = i + 1;
+        }
+    }
+    else if(i == limit - 1){//shrink the range we have to walk
+        while(limit > 0 && !active[limit - 1]){
+            limit--;
+        }
+    }
+}
+
+void SpectralSynthesis::synthesizeGrain(){
+    int i, j, k, mirror, first, last, lastLobe = 2 * LOBEHALFWIDTH * LOBEOVERSAMPLING;
+    double advance = M_PI * hopSize / samplingRate, p;//double, or the rounding shows up as a frequency error
+    float binsPerHz = fftSize / samplingRate, nyquist = samplingRate * 0.5, centre, position, fraction, w, a, real, imag;
+    memset(complexBuffer, 0, sizeof(fftwf_complex) * numBins);
+    for(i = 0; i < limit; ++i){
+        if(!active[i]){
+            continue;
+        }
+        //trapezoidal integration of the frequency over the last hop, wrapped to [-pi, pi)
+        p = phase[i] + advance * ((double)lastFrequency[i] + frequency[i]);
+        phase[i] = (float)(p - 2.0 * M_PI * floor((p + M_PI) / (2.0 * M_PI)));
+        lastFrequency[i] = frequency[i];
+        a = 0.5 * amplitude[i] * gain[i];//the other half lives at the negative frequency
+        if(a == 0.0 || frequency[i] <= 0.0 || frequency[i] >= nyquist){
+            continue;
+        }
+        real = a * cosf(phase[i]);
+        imag = a * sinf(phase[i]);
+        centre = frequency[i] * binsPerHz;
+        first = (int)ceilf(centre - LOBEHALFWIDTH);
+        last = (int)floorf(centre + LOBEHALFWIDTH);
+        for(j = first; j <= last; ++j){
+            position = (j - centre + LOBEHALFWIDTH) * LOBEOVERSAMPLING;
+            k = std::min((int)position, lastLobe - 1);
+            fraction = position - k;
+            w = lobe[k] + fraction * (lobe[k + 1] - lobe[k]);
+            if(j > 0 && j < numBins - 1){
+                complexBuffer[j][0] += w * real;
+                complexBuffer[j][1] += w * imag;
+            }
+            else if(j == 0 || j == numBins - 1){//dc and nyquist get the lobe and its image, which are conjugates
+                complexBuffer[j][0] += 2.0 * w * real;
+            }
+            else{//lobe spills past dc or nyquist, fold it back conjugated
+                mirror = (j < 0)?-j:fftSize - j;
+                complexBuffer[mirror][0] += w * real;
+                complexBuffer[mirror][1] -= w * imag;
+            }
+        }
+    }
+    fftwf_execute_dft_c2r(backwardPlan, complexBuffer, realBuffer);
+    //the grain comes out zero phase, i.e. centred on sample 0 and wrapped around the end of the buffer
+    for(i = -hopSize; i < hopSize; ++i){
+        grain[i + hopSize] = realBuffer[(i < 0)?i + fftSize:i] * grainWindow[i + hopSize];
+    }
+    outputBuffer->add(grain, 2 * hopSize, hopSize);
+    numReady += hopSize;
+}
+
+void SpectralSynthesis::render(float * out, const int n){
+    int count;
+    for(int i = 0; i < n; i += count){
+        if(numReady == 0){
+            synthesizeGrain();
+        }
+        count = std::min(numReady, n - i);
+        outputBuffer->take(out + i, count);
+        numReady -= count;
+    }
+}
+
+void SpectralSynthesis::reset(){
+    outputBuffer->clear();
+    numReady = 0;
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    SpectralSynthesis.h
+    Created: 17 Oct 2026 5:10:02am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef SPECTRALSYNTHESIS_H_INCLUDED
+#define SPECTRALSYNTHESIS_H_INCLUDED
+
+#include <fftw3.h>
+#include "RingBuffer.h"
+
+#define LOBEHALFWIDTH 4 //bins either side of a partial's centre, covers the Blackman-Harris main lobe
+#define LOBEOVERSAMPLING 64 //table points per bin
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  SpectralSynthesis Class (inverse FFT overlap-add)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//drop-in for OscillatorBank that builds each hop in the frequency domain instead: every active partial
+//adds its Blackman-Harris main lobe to one spectrum, a single inverse FFT turns that into a grain, and the
+//grains are overlap-added a hop apart. cost per hop is O(fft size log fft size) plus a few bins per
+//partial, so it stays flat as the track count goes up, where the bank is O(partials x samples).
+//
+//the FFT is 4 hops long. the grain is the central two hops of the inverse FFT, divided by the Blackman-
+//Harris window and multiplied by a triangle, so consecutive grains crossfade linearly and sum to one
+//(Rodet & Depalle's FFT^-1). amplitude and frequency move at grain rate, phase is integrated from frequency.
+class SpectralSynthesis{
+private:
+    float * amplitude, * frequency, * lastFrequency, * phase, * gain;//phase in radians, at the next grain's centre
+    bool * active;
+    float * lobe;//Blackman-Harris transform, (2 * LOBEHALFWIDTH * LOBEOVERSAMPLING + 1) points
+    float * grainWindow;//triangle / (Blackman-Harris * fft size) over the central two hops
+    float * realBuffer, * grain;
+    fftwf_complex * complexBuffer;
+    fftwf_plan backwardPlan;
+    RingBuffer<float> * outputBuffer;//overlap-added grains, read back by render()
+    float samplingRate;
+    int size, limit, hopSize, fftSize, numBins, numReady;//numReady: samples in outputBuffer every grain has been added to
+
+    void synthesizeGrain();
+public:
+    SpectralSynthesis(const float sr, const int n, const int hop);
+    ~SpectralSynthesis();
+
+    //same slot semantics as OscillatorBank. d (the ramp length) is always one grain here
+    void start(const int i, const float a, const float f, const float p);
+    void update(const int i, const float a, const float f, const float p, const int d);
+    void stop(const int i);
+
+    //getters
+    int getSize() const{return size;}
+    int getHopSize() const{return hopSize;}
+    int getFFTSize() const{return fftSize;}
+
+    //setters
+    void setActive(const int i, const bool a);
+    void setGain(const int i, const float g){gain[i] = g;}
+
+    //overwrites out with the sum of every active slot's output * gain, synthesizing grains as they're needed
+    void render(float * out, const int n);
+    void reset();//drop anything already overlap-added
+};
+
+#endif  // SPECTRALSYNTHESIS_H_INCLUDED
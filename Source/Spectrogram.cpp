@@ -24,6 +24,14 @@
 
 
 //[MiscUserDefs] You can add your own user definitions and misc code here...
+#define SPECTROGRAMFPS 30
+#define SPECTROGRAMCHANNELS 2 //colours we have, any further channels aren't drawn
+#define WATERFALLRANGE 60.0f //dB below each frame's loudest bin that the waterfall fades into the background over
+static const Colour background(0xff1c4151);
+static const Colour channelColours[SPECTROGRAMCHANNELS] = {
+    Colour(0.75f, 1.0f, 1.0f, 1.0f),
+    Colour(0.15f, 1.0f, 1.0f, 1.0f)//yellow
+};
 //[/MiscUserDefs]
 
 //==============================================================================
@@ -32,16 +40,21 @@ Spectrogram::Spectrogram (SmodelsAudioProcessor* ownerFilter, const Rectangle<in
 {
 
     //[UserPreSize]
+    numEdgeColumns = 0;
+    kernels = spectrum::select();
+    view = VIEW::BARS;
+    scale = DisplaySpectrum::SCALE::LOG;
+    reduction = DisplaySpectrum::REDUCTION::MAX;
     //[/UserPreSize]
 
     setSize (512, 256);
 
     //[Constructor] You can add your own custom stuff here..
     //SmodelsAudioProcessor* ourProcessor = getProcessor();
-    graphResolution = ourProcessor->getAnalysisSize() / 2 + 1;
     setBounds(bounds);
+    ourProcessor->setDisplayMode(scale, reduction);
     //std::cout << "constructor spectro right bound: " << bounds.getRight() << std::endl;
-    startTimer(200);
+    startTimer(1000 / SPECTROGRAMFPS);//a repaint is one blit now, so it can keep up with the hops
     //std::cout << "spectrogram constructor loc: " << ourProcessor << std::endl;
     //[/Constructor]
 }
@@ -66,41 +79,19 @@ void Spectrogram::paint (Graphics& g)
     g.fillAll (Colour (0xff1c4151));
 
     //[UserPaint] Add your own custom painting code here..
-    bounds = g.getClipBounds();
-    //std::cout << "attempting to paint spectrogram" << std::endl;
-    int numChannels = ourProcessor->getNumInputChannels(), channel = 0, i;
-    float graphWidth = bounds.getWidth(), graphHeight = bounds.getHeight(), graphBottom = bounds.getBottom(),
-    graphTop = 0.0, barWidth = graphWidth / graphResolution, barLeft, barTop = graphHeight, barHeight, alpha = 0.5f;
-    float * amplitudes, amp, ampNormFactor;
-    for(; channel < numChannels; ++channel){
-        g.beginTransparencyLayer(alpha);
-        if(channel == 0){
-            g.setColour(Colour(0.75, 1.0, 1.0f, 1.0f));
-        }
-        else{
-            g.setColour(Colour(0.15, 1.0, 1.0f, 1.0f));//yellow
-        }
-        amplitudes = ourProcessor->getAnalysisResults(channel, Analysis::PARAMETER::AMP);
-		ampNormFactor = ourProcessor->getAmpNormFactor(channel);
-        for(i = 0; i < graphResolution; ++i){
-            barLeft = (i * barWidth);
-			//convert back from decibels
-            amp = amplitudes[i] * ampNormFactor;
-			//std::cout << "spectrogram"
-            if(amp > 0.0f){
-                barHeight = (amp < 1.0f)?graphHeight * amp:graphHeight; //clamp bar height to full for clipped magnitudes
-                barTop = graphTop + (graphHeight - barHeight);
-                g.drawVerticalLine(barLeft, barTop, graphBottom);
-            }
-        }
-        g.endTransparencyLayer();
-    }
+    g.drawImageAt(image, 0, 0);
     //[/UserPaint]
 }
 
 void Spectrogram::resized()
 {
     //[UserResized] Add your own custom resize handling here..
+    int width = jmax(1, getWidth());
+    image = Image(Image::RGB, width, jmax(1, getHeight()), false);
+    image.clear(image.getBounds(), background);
+    pixels.resize(width * SPECTROGRAMCHANNELS);
+    pixelEdges.resize(width + 1);
+    numEdgeColumns = 0;
     //[/UserResized]
 }
 
@@ -110,11 +101,97 @@ void Spectrogram::resized()
 void Spectrogram::timerCallback()
 {
     //std::cout << "spectrogram timer called" << std::endl;
-    if(ourProcessor->NeedsSpectrogramUpdate()){
+    bool update = false;
+    ourProcessor->pinDisplay();//render() reads the same set
+    for(int channel = 0; channel < ourProcessor->getNumInputChannels(); ++channel){
+        update = ourProcessor->refreshSpectrum(channel) || update;//every channel, so none of them lags a frame behind
+    }
+    if(update){
+        render();
         repaint();
-        ourProcessor->ClearSpectrogramUpdateFlag();
     }
+    ourProcessor->unpinDisplay();
 };
+
+void Spectrogram::render(){
+    const int width = image.getWidth(), height = image.getHeight();
+    int numChannels = jmin(ourProcessor->getNumInputChannels(), SPECTROGRAMCHANNELS), channel, x, c, top;
+    bool drawn[SPECTROGRAMCHANNELS] = {false};
+    float a, * p;
+    Colour colour;
+    const DisplaySpectrum * spectrum;
+    for(channel = 0; channel < numChannels; ++channel){
+        //a consistent snapshot, the audio thread publishes into other slots until we refresh again
+        spectrum = ourProcessor->getSpectrum(channel);
+        if(spectrum == nullptr || spectrum->numColumns == 0){
+            continue;
+        }
+        if(spectrum->numColumns != numEdgeColumns){//more pixels than columns just repeats columns
+            for(x = 0; x <= width; ++x){
+                pixelEdges[x] = (int)((long long)x * spectrum->numColumns / width);
+            }
+            pixelEdges[width] = spectrum->numColumns;
+            numEdgeColumns = spectrum->numColumns;
+        }
+        //the same reduction the analysis used, now from its columns down to ours
+        kernels.reduce(spectrum->amplitudes, &pixelEdges[0], &pixels[channel * width], width, 1.0f,
+                       spectrum->reduction == DisplaySpectrum::REDUCTION::MEAN);
+        drawn[channel] = true;
+    }
+    if(view == VIEW::BARS){
+        Graphics g(image);
+        g.fillAll(background);
+        for(channel = 0; channel < numChannels; ++channel){
+            if(!drawn[channel]){
+                continue;
+            }
+            g.setColour(channelColours[channel].withAlpha(0.5f));
+            p = &pixels[channel * width];
+            for(x = 0; x < width; ++x){
+                if(p[x] > 0.0f){
+                    top = roundToInt(height * (1.0f - jmin(p[x], 1.0f)));//clipped magnitudes get a full bar
+                    g.fillRect(x, top, 1, height - top);
+                }
+            }
+        }
+    }
+    else{
+        image.moveImageSection(0, 0, 0, 1, width, height - 1);
+        Image::BitmapData row(image, 0, height - 1, width, 1, Image::BitmapData::writeOnly);
+        for(x = 0; x < width; ++x){
+            colour = background;
+            for(c = 0; c < numChannels; ++c){
+                if(drawn[c] && pixels[c * width + x] > 0.0f){
+                    a = 1.0f + 20.0f * log10f(pixels[c * width + x]) / WATERFALLRANGE;
+                    colour = colour.interpolatedWith(channelColours[c], jlimit(0.0f, 1.0f, a));
+                }
+            }
+            row.setPixelColour(x, 0, colour);
+        }
+    }
+}
+
+void Spectrogram::setView(const VIEW v){
+    view = v;
+    image.clear(image.getBounds(), background);//the waterfall starts over
+    repaint();
+}
+
+void Spectrogram::setMode(const DisplaySpectrum::SCALE s, const DisplaySpectrum::REDUCTION r){
+    scale = s;
+    reduction = r;
+    ourProcessor->setDisplayMode(s, r);
+}
+
+void Spectrogram::mouseDown(const MouseEvent &e){
+    if(e.mods.isPopupMenu()){
+        setMode((scale == DisplaySpectrum::SCALE::LOG)?DisplaySpectrum::SCALE::LINEAR:DisplaySpectrum::SCALE::LOG, reduction);
+    }
+}
+
+void Spectrogram::mouseDoubleClick(const MouseEvent &e){
+    setView((view == VIEW::BARS)?VIEW::WATERFALL:VIEW::BARS);
+}
 //[/MiscUserCode]
 
 
@@ -23,6 +23,7 @@
 //[Headers]     -- You can add your own extra header files here --
 #include "JuceHeader.h"
 #include "PluginProcessor.h"
+#include <vector>
 //[/Headers]
 
 
@@ -45,13 +46,12 @@ public:
 
     //==============================================================================
     //[UserMethods]     -- You can add your own custom methods in this section.
+    enum class VIEW{BARS, WATERFALL};
     void timerCallback();
-    int getGraphResolution() const {
-        return graphResolution;
-    }
-    void setGraphResolution(int newRes){
-        graphResolution = newRes;
-    };
+    void setView(const VIEW v);
+    void setMode(const DisplaySpectrum::SCALE s, const DisplaySpectrum::REDUCTION r);//the analysis reduces to these columns
+    void mouseDown(const MouseEvent &e);//right click flips between log and linear frequency
+    void mouseDoubleClick(const MouseEvent &e);//flips between the bars and the waterfall
     //[/UserMethods]
 
     void paint (Graphics& g);
@@ -61,9 +61,17 @@ public:
 
 private:
     //[UserVariables]   -- You can add your own custom variables in this section.
-    int graphResolution;
+    void render();//draws the latest spectra into the cached image, paint() only blits it
     SmodelsAudioProcessor* ourProcessor;
     Rectangle<int> bounds;
+    Image image;//whichever view is showing. the waterfall scrolls up a row per spectrum, bars are redrawn
+    std::vector<float> pixels;//one value per pixel column, per channel
+    std::vector<int> pixelEdges;//spectrum columns to pixel columns, laid out for numEdgeColumns
+    int numEdgeColumns;
+    spectrum::Kernels kernels;
+    VIEW view;
+    DisplaySpectrum::SCALE scale;
+    DisplaySpectrum::REDUCTION reduction;
     //[/UserVariables]
 
     //==============================================================================
@@ -0,0 +1,462 @@
+/*
+  ==============================================================================
+
+    SpectrumKernels.cpp
+    Created: 17 Oct 2026 4:36:19am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "SpectrumKernels.h"
+
+#define ONEOVERTWOPI 0.15915494f
+#define HALFPI 1.57079633f
+#define PIF 3.14159265f
+
+namespace spectrum{
+
+//////////////////////////////////////////////////////////////
+//  Scalar (fast approximations, no SIMD)
+//////////////////////////////////////////////////////////////
+static float amplitudesScalar(const fftwf_complex * X, float * amplitudes, const int begin, const int end, const float scale){
+    float real, imag, amp, maxAmp = 0.0f;
+    for(int i = begin; i < end; ++i){
+        real = X[i][0];
+        imag = X[i][1];
+        amp = 2.0f * sqrtf(real * real + imag * imag) * scale;
+        maxAmp = std::max(maxAmp, amp);
+        amplitudes[i] = amp;
+    }
+    return maxAmp;
+}
+static void phasesScalar(const fftwf_complex * X, float * phases, const int begin, const int end){
+    for(int i = begin; i < end; ++i){
+        phases[i] = (fastAtan2(X[i][1], X[i][0]) + PIF) * ONEOVERTWOPI;
+    }
+}
+static float peakScalar(const fftwf_complex * X, const int begin, const int end){
+    float real, imag, maxPower = 0.0f;
+    for(int i = begin; i < end; ++i){
+        real = X[i][0];
+        imag = X[i][1];
+        maxPower = std::max(maxPower, real * real + imag * imag);
+    }
+    return maxPower;
+}
+static void magnitudesScalar(const fftwf_complex * X, float * magnitudes, const int begin, const int end, const float gain, const float crumb){
+    float real, imag;
+    for(int i = begin; i < end; ++i){
+        real = X[i][0];
+        imag = X[i][1];
+        magnitudes[i] = TWENTYLOG10OF2 * fastLog2(sqrtf(real * real + imag * imag) * gain + crumb);
+    }
+}
+static float rangeScalar(const float * x, const int begin, const int end, const bool mean){
+    float r = 0.0f;
+    for(int i = begin; i < end; ++i){
+        r = (mean)?r + x[i]:std::max(r, x[i]);//x is an amplitude spectrum, never negative
+    }
+    return r;
+}
+static void reduceScalar(const float * x, const int * edges, float * out, const int numColumns, const float scale, const bool mean){
+    int begin, end;
+    for(int c = 0; c < numColumns; ++c){
+        begin = edges[c];
+        end = std::max(edges[c + 1], begin + 1);
+        out[c] = rangeScalar(x, begin, end, mean) * ((mean)?scale / (end - begin):scale);
+    }
+}
+
+#if SIMD_X86
+//////////////////////////////////////////////////////////////
+//  SSE2
+//////////////////////////////////////////////////////////////
+static inline __m128 atan2SSE2(const __m128 y, const __m128 x){
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)), signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    __m128 ax = _mm_and_ps(x, absMask), ay = _mm_and_ps(y, absMask), hi = _mm_max_ps(ax, ay), lo = _mm_min_ps(ax, ay), a, s, r, swap, neg;
+    a = _mm_and_ps(_mm_div_ps(lo, hi), _mm_cmpgt_ps(hi, _mm_setzero_ps()));//0/0 -> 0
+    s = _mm_mul_ps(a, a);
+    r = _mm_add_ps(_mm_set1_ps(ATAN_C9), _mm_mul_ps(s, _mm_set1_ps(ATAN_C11)));
+    r = _mm_add_ps(_mm_set1_ps(ATAN_C7), _mm_mul_ps(s, r));
+    r = _mm_add_ps(_mm_set1_ps(ATAN_C5), _mm_mul_ps(s, r));
+    r = _mm_add_ps(_mm_set1_ps(ATAN_C3), _mm_mul_ps(s, r));
+    r = _mm_mul_ps(a, _mm_add_ps(_mm_set1_ps(ATAN_C1), _mm_mul_ps(s, r)));
+    swap = _mm_cmpgt_ps(ay, ax);
+    r = _mm_or_ps(_mm_and_ps(swap, _mm_sub_ps(_mm_set1_ps(HALFPI), r)), _mm_andnot_ps(swap, r));
+    neg = _mm_cmplt_ps(x, _mm_setzero_ps());
+    r = _mm_or_ps(_mm_and_ps(neg, _mm_sub_ps(_mm_set1_ps(PIF), r)), _mm_andnot_ps(neg, r));
+    return _mm_xor_ps(r, _mm_and_ps(y, signMask));
+}
+static inline __m128 log2SSE2(const __m128 x){
+    __m128i bits = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127))),
+    t = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000))), _mm_set1_ps(1.0f)), p;
+    p = _mm_add_ps(_mm_set1_ps(LOG2_C4), _mm_mul_ps(t, _mm_set1_ps(LOG2_C5)));
+    p = _mm_add_ps(_mm_set1_ps(LOG2_C3), _mm_mul_ps(t, p));
+    p = _mm_add_ps(_mm_set1_ps(LOG2_C2), _mm_mul_ps(t, p));
+    p = _mm_add_ps(_mm_set1_ps(LOG2_C1), _mm_mul_ps(t, p));
+    p = _mm_add_ps(_mm_set1_ps(LOG2_C0), _mm_mul_ps(t, p));
+    return _mm_add_ps(e, _mm_mul_ps(t, p));
+}
+static inline void deinterleaveSSE2(const fftwf_complex * X, __m128 &real, __m128 &imag){
+    __m128 a = _mm_loadu_ps(X[0]), b = _mm_loadu_ps(X[2]);
+    real = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    imag = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static float amplitudesSSE2(const fftwf_complex * X, float * amplitudes, const int begin, const int end, const float scale){
+    const __m128 twoScale = _mm_set1_ps(2.0f * scale);
+    __m128 real, imag, amp, maxAmp = _mm_setzero_ps();
+    float result;
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        deinterleaveSSE2(X + i, real, imag);
+        amp = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(real, real), _mm_mul_ps(imag, imag))), twoScale);
+        maxAmp = _mm_max_ps(maxAmp, amp);
+        _mm_storeu_ps(amplitudes + i, amp);
+    }
+    maxAmp = _mm_max_ps(maxAmp, _mm_movehl_ps(maxAmp, maxAmp));
+    maxAmp = _mm_max_ss(maxAmp, _mm_shuffle_ps(maxAmp, maxAmp, 1));
+    result = _mm_cvtss_f32(maxAmp);
+    return std::max(result, amplitudesScalar(X, amplitudes, i, end, scale));
+}
+static void phasesSSE2(const fftwf_complex * X, float * phases, const int begin, const int end){
+    const __m128 pi = _mm_set1_ps(PIF), oneOverTwoPi = _mm_set1_ps(ONEOVERTWOPI);
+    __m128 real, imag;
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        deinterleaveSSE2(X + i, real, imag);
+        _mm_storeu_ps(phases + i, _mm_mul_ps(_mm_add_ps(atan2SSE2(imag, real), pi), oneOverTwoPi));
+    }
+    phasesScalar(X, phases, i, end);
+}
+static float peakSSE2(const fftwf_complex * X, const int begin, const int end){
+    __m128 real, imag, maxPower = _mm_setzero_ps();
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        deinterleaveSSE2(X + i, real, imag);
+        maxPower = _mm_max_ps(maxPower, _mm_add_ps(_mm_mul_ps(real, real), _mm_mul_ps(imag, imag)));
+    }
+    maxPower = _mm_max_ps(maxPower, _mm_movehl_ps(maxPower, maxPower));
+    maxPower = _mm_max_ss(maxPower, _mm_shuffle_ps(maxPower, maxPower, 1));
+    return std::max(_mm_cvtss_f32(maxPower), peakScalar(X, i, end));
+}
+static void reduceSSE2(const float * x, const int * edges, float * out, const int numColumns, const float scale, const bool mean){
+    __m128 r;
+    float tail;
+    int begin, end, i;
+    for(int c = 0; c < numColumns; ++c){
+        begin = edges[c];
+        end = std::max(edges[c + 1], begin + 1);
+        r = _mm_setzero_ps();
+        for(i = begin; i + 4 <= end; i += 4){
+            r = (mean)?_mm_add_ps(r, _mm_loadu_ps(x + i)):_mm_max_ps(r, _mm_loadu_ps(x + i));
+        }
+        tail = rangeScalar(x, i, end, mean);
+        if(mean){
+            r = _mm_add_ps(r, _mm_movehl_ps(r, r));
+            r = _mm_add_ss(r, _mm_shuffle_ps(r, r, 1));
+            out[c] = (_mm_cvtss_f32(r) + tail) * scale / (end - begin);
+        }
+        else{
+            r = _mm_max_ps(r, _mm_movehl_ps(r, r));
+            r = _mm_max_ss(r, _mm_shuffle_ps(r, r, 1));
+            out[c] = std::max(_mm_cvtss_f32(r), tail) * scale;
+        }
+    }
+}
+static void magnitudesSSE2(const fftwf_complex * X, float * magnitudes, const int begin, const int end, const float gain, const float crumb){
+    const __m128 g = _mm_set1_ps(gain), c = _mm_set1_ps(crumb), dB = _mm_set1_ps(TWENTYLOG10OF2);
+    __m128 real, imag, amp;
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        deinterleaveSSE2(X + i, real, imag);
+        amp = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(real, real), _mm_mul_ps(imag, imag)));
+        _mm_storeu_ps(magnitudes + i, _mm_mul_ps(dB, log2SSE2(_mm_add_ps(_mm_mul_ps(amp, g), c))));
+    }
+    magnitudesScalar(X, magnitudes, i, end, gain, crumb);
+}
+#endif
+
+#if SIMD_HAS_AVX2
+//////////////////////////////////////////////////////////////
+//  AVX2
+//////////////////////////////////////////////////////////////
+SIMD_TARGET_AVX2 static inline __m256 atan2AVX2(const __m256 y, const __m256 x){
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)), signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    __m256 ax = _mm256_and_ps(x, absMask), ay = _mm256_and_ps(y, absMask), hi = _mm256_max_ps(ax, ay), lo = _mm256_min_ps(ax, ay), a, s, r;
+    a = _mm256_and_ps(_mm256_div_ps(lo, hi), _mm256_cmp_ps(hi, _mm256_setzero_ps(), _CMP_GT_OQ));//0/0 -> 0
+    s = _mm256_mul_ps(a, a);
+    r = _mm256_fmadd_ps(s, _mm256_set1_ps(ATAN_C11), _mm256_set1_ps(ATAN_C9));
+    r = _mm256_fmadd_ps(s, r, _mm256_set1_ps(ATAN_C7));
+    r = _mm256_fmadd_ps(s, r, _mm256_set1_ps(ATAN_C5));
+    r = _mm256_fmadd_ps(s, r, _mm256_set1_ps(ATAN_C3));
+    r = _mm256_mul_ps(a, _mm256_fmadd_ps(s, r, _mm256_set1_ps(ATAN_C1)));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(HALFPI), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PIF), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));//not the sign bit, -0 counts as 0
+    return _mm256_xor_ps(r, _mm256_and_ps(y, signMask));
+}
+SIMD_TARGET_AVX2 static inline __m256 log2AVX2(const __m256 x){
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127))),
+    t = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000))), _mm256_set1_ps(1.0f)), p;
+    p = _mm256_fmadd_ps(t, _mm256_set1_ps(LOG2_C5), _mm256_set1_ps(LOG2_C4));
+    p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(LOG2_C3));
+    p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(LOG2_C2));
+    p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(LOG2_C1));
+    p = _mm256_fmadd_ps(t, p, _mm256_set1_ps(LOG2_C0));
+    return _mm256_fmadd_ps(t, p, e);
+}
+SIMD_TARGET_AVX2 static inline void deinterleaveAVX2(const fftwf_complex * X, __m256 &real, __m256 &imag){
+    __m256 a = _mm256_loadu_ps(X[0]), b = _mm256_loadu_ps(X[4]);
+    //in-lane shuffles leave the 64 bit chunks as 0 2 1 3, so put them back in order
+    real = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+    imag = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+SIMD_TARGET_AVX2 static float amplitudesAVX2(const fftwf_complex * X, float * amplitudes, const int begin, const int end, const float scale){
+    const __m256 twoScale = _mm256_set1_ps(2.0f * scale);
+    __m256 real, imag, amp, maxAmp = _mm256_setzero_ps();
+    __m128 folded;
+    int i = begin;
+    for(; i + 8 <= end; i += 8){
+        deinterleaveAVX2(X + i, real, imag);
+        amp = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_fmadd_ps(real, real, _mm256_mul_ps(imag, imag))), twoScale);
+        maxAmp = _mm256_max_ps(maxAmp, amp);
+        _mm256_storeu_ps(amplitudes + i, amp);
+    }
+    folded = _mm_max_ps(_mm256_castps256_ps128(maxAmp), _mm256_extractf128_ps(maxAmp, 1));
+    folded = _mm_max_ps(folded, _mm_movehl_ps(folded, folded));
+    folded = _mm_max_ss(folded, _mm_shuffle_ps(folded, folded, 1));
+    return std::max(_mm_cvtss_f32(folded), amplitudesScalar(X, amplitudes, i, end, scale));
+}
+SIMD_TARGET_AVX2 static void phasesAVX2(const fftwf_complex * X, float * phases, const int begin, const int end){
+    const __m256 pi = _mm256_set1_ps(PIF), oneOverTwoPi = _mm256_set1_ps(ONEOVERTWOPI);
+    __m256 real, imag;
+    int i = begin;
+    for(; i + 8 <= end; i += 8){
+        deinterleaveAVX2(X + i, real, imag);
+        _mm256_storeu_ps(phases + i, _mm256_mul_ps(_mm256_add_ps(atan2AVX2(imag, real), pi), oneOverTwoPi));
+    }
+    phasesScalar(X, phases, i, end);
+}
+SIMD_TARGET_AVX2 static float peakAVX2(const fftwf_complex * X, const int begin, const int end){
+    __m256 real, imag, maxPower = _mm256_setzero_ps();
+    __m128 folded;
+    int i = begin;
+    for(; i + 8 <= end; i += 8){
+        deinterleaveAVX2(X + i, real, imag);
+        maxPower = _mm256_max_ps(maxPower, _mm256_fmadd_ps(real, real, _mm256_mul_ps(imag, imag)));
+    }
+    folded = _mm_max_ps(_mm256_castps256_ps128(maxPower), _mm256_extractf128_ps(maxPower, 1));
+    folded = _mm_max_ps(folded, _mm_movehl_ps(folded, folded));
+    folded = _mm_max_ss(folded, _mm_shuffle_ps(folded, folded, 1));
+    return std::max(_mm_cvtss_f32(folded), peakScalar(X, i, end));
+}
+SIMD_TARGET_AVX2 static void reduceAVX2(const float * x, const int * edges, float * out, const int numColumns, const float scale, const bool mean){
+    __m256 r;
+    __m128 folded;
+    float tail;
+    int begin, end, i;
+    for(int c = 0; c < numColumns; ++c){
+        begin = edges[c];
+        end = std::max(edges[c + 1], begin + 1);
+        r = _mm256_setzero_ps();
+        for(i = begin; i + 8 <= end; i += 8){
+            r = (mean)?_mm256_add_ps(r, _mm256_loadu_ps(x + i)):_mm256_max_ps(r, _mm256_loadu_ps(x + i));
+        }
+        tail = rangeScalar(x, i, end, mean);
+        if(mean){
+            folded = _mm_add_ps(_mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1));
+            folded = _mm_add_ps(folded, _mm_movehl_ps(folded, folded));
+            folded = _mm_add_ss(folded, _mm_shuffle_ps(folded, folded, 1));
+            out[c] = (_mm_cvtss_f32(folded) + tail) * scale / (end - begin);
+        }
+        else{
+            folded = _mm_max_ps(_mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1));
+            folded = _mm_max_ps(folded, _mm_movehl_ps(folded, folded));
+            folded = _mm_max_ss(folded, _mm_shuffle_ps(folded, folded, 1));
+            out[c] = std::max(_mm_cvtss_f32(folded), tail) * scale;
+        }
+    }
+}
+SIMD_TARGET_AVX2 static void magnitudesAVX2(const fftwf_complex * X, float * magnitudes, const int begin, const int end, const float gain, const float crumb){
+    const __m256 g = _mm256_set1_ps(gain), c = _mm256_set1_ps(crumb), dB = _mm256_set1_ps(TWENTYLOG10OF2);
+    __m256 real, imag, amp;
+    int i = begin;
+    for(; i + 8 <= end; i += 8){
+        deinterleaveAVX2(X + i, real, imag);
+        amp = _mm256_sqrt_ps(_mm256_fmadd_ps(real, real, _mm256_mul_ps(imag, imag)));
+        _mm256_storeu_ps(magnitudes + i, _mm256_mul_ps(dB, log2AVX2(_mm256_fmadd_ps(amp, g, c))));
+    }
+    magnitudesScalar(X, magnitudes, i, end, gain, crumb);
+}
+#endif
+
+#if SIMD_NEON
+//////////////////////////////////////////////////////////////
+//  NEON
+//////////////////////////////////////////////////////////////
+static inline float32x4_t divideNEON(const float32x4_t a, const float32x4_t b){
+#if defined(__aarch64__)
+    return vdivq_f32(a, b);
+#else//no vdivq on armv7, reciprocal estimate + 2 newton steps instead
+    float32x4_t r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+#endif
+}
+static inline float32x4_t atan2NEON(const float32x4_t y, const float32x4_t x){
+    float32x4_t ax = vabsq_f32(x), ay = vabsq_f32(y), hi = vmaxq_f32(ax, ay), lo = vminq_f32(ax, ay), a, s, r;
+    uint32x4_t valid = vcgtq_f32(hi, vdupq_n_f32(0.0f));
+    a = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(divideNEON(lo, hi)), valid));//0/0 -> 0
+    s = vmulq_f32(a, a);
+    r = vmlaq_f32(vdupq_n_f32(ATAN_C9), s, vdupq_n_f32(ATAN_C11));
+    r = vmlaq_f32(vdupq_n_f32(ATAN_C7), s, r);
+    r = vmlaq_f32(vdupq_n_f32(ATAN_C5), s, r);
+    r = vmlaq_f32(vdupq_n_f32(ATAN_C3), s, r);
+    r = vmulq_f32(a, vmlaq_f32(vdupq_n_f32(ATAN_C1), s, r));
+    r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(HALFPI), r), r);
+    r = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vsubq_f32(vdupq_n_f32(PIF), r), r);
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(r), vandq_u32(vreinterpretq_u32_f32(y), vdupq_n_u32(0x80000000))));
+}
+static inline float32x4_t log2NEON(const float32x4_t x){
+    uint32x4_t bits = vreinterpretq_u32_f32(x);
+    float32x4_t e = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127))),
+    t = vsubq_f32(vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007FFFFF)), vdupq_n_u32(0x3F800000))), vdupq_n_f32(1.0f)), p;
+    p = vmlaq_f32(vdupq_n_f32(LOG2_C4), t, vdupq_n_f32(LOG2_C5));
+    p = vmlaq_f32(vdupq_n_f32(LOG2_C3), t, p);
+    p = vmlaq_f32(vdupq_n_f32(LOG2_C2), t, p);
+    p = vmlaq_f32(vdupq_n_f32(LOG2_C1), t, p);
+    p = vmlaq_f32(vdupq_n_f32(LOG2_C0), t, p);
+    return vmlaq_f32(e, t, p);
+}
+
+static inline float32x4_t sqrtNEON(const float32x4_t x){
+#if defined(__aarch64__)
+    return vsqrtq_f32(x);
+#else//reciprocal sqrt estimate + 2 newton steps, masked so 0 stays 0
+    float32x4_t r = vrsqrteq_f32(x);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(x, r), r), r);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(x, r), r), r);
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vmulq_f32(x, r)), vcgtq_f32(x, vdupq_n_f32(0.0f))));
+#endif
+}
+
+static float amplitudesNEON(const fftwf_complex * X, float * amplitudes, const int begin, const int end, const float scale){
+    const float32x4_t twoScale = vdupq_n_f32(2.0f * scale);
+    float32x4_t amp, maxAmp = vdupq_n_f32(0.0f);
+    float32x4x2_t ri;
+    float32x2_t folded;
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        ri = vld2q_f32(X[i]);//deinterleaves real/imag for us
+        amp = vmulq_f32(sqrtNEON(vmlaq_f32(vmulq_f32(ri.val[0], ri.val[0]), ri.val[1], ri.val[1])), twoScale);
+        maxAmp = vmaxq_f32(maxAmp, amp);
+        vst1q_f32(amplitudes + i, amp);
+    }
+    folded = vpmax_f32(vget_low_f32(maxAmp), vget_high_f32(maxAmp));
+    folded = vpmax_f32(folded, folded);
+    return std::max(vget_lane_f32(folded, 0), amplitudesScalar(X, amplitudes, i, end, scale));
+}
+static void phasesNEON(const fftwf_complex * X, float * phases, const int begin, const int end){
+    const float32x4_t pi = vdupq_n_f32(PIF), oneOverTwoPi = vdupq_n_f32(ONEOVERTWOPI);
+    float32x4x2_t ri;
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        ri = vld2q_f32(X[i]);
+        vst1q_f32(phases + i, vmulq_f32(vaddq_f32(atan2NEON(ri.val[1], ri.val[0]), pi), oneOverTwoPi));
+    }
+    phasesScalar(X, phases, i, end);
+}
+static float peakNEON(const fftwf_complex * X, const int begin, const int end){
+    float32x4_t maxPower = vdupq_n_f32(0.0f);
+    float32x4x2_t ri;
+    float32x2_t folded;
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        ri = vld2q_f32(X[i]);
+        maxPower = vmaxq_f32(maxPower, vmlaq_f32(vmulq_f32(ri.val[0], ri.val[0]), ri.val[1], ri.val[1]));
+    }
+    folded = vpmax_f32(vget_low_f32(maxPower), vget_high_f32(maxPower));
+    folded = vpmax_f32(folded, folded);
+    return std::max(vget_lane_f32(folded, 0), peakScalar(X, i, end));
+}
+static void reduceNEON(const float * x, const int * edges, float * out, const int numColumns, const float scale, const bool mean){
+    float32x4_t r;
+    float32x2_t folded;
+    float tail;
+    int begin, end, i;
+    for(int c = 0; c < numColumns; ++c){
+        begin = edges[c];
+        end = std::max(edges[c + 1], begin + 1);
+        r = vdupq_n_f32(0.0f);
+        for(i = begin; i + 4 <= end; i += 4){
+            r = (mean)?vaddq_f32(r, vld1q_f32(x + i)):vmaxq_f32(r, vld1q_f32(x + i));
+        }
+        tail = rangeScalar(x, i, end, mean);
+        if(mean){
+            folded = vpadd_f32(vget_low_f32(r), vget_high_f32(r));
+            folded = vpadd_f32(folded, folded);
+            out[c] = (vget_lane_f32(folded, 0) + tail) * scale / (end - begin);
+        }
+        else{
+            folded = vpmax_f32(vget_low_f32(r), vget_high_f32(r));
+            folded = vpmax_f32(folded, folded);
+            out[c] = std::max(vget_lane_f32(folded, 0), tail) * scale;
+        }
+    }
+}
+static void magnitudesNEON(const fftwf_complex * X, float * magnitudes, const int begin, const int end, const float gain, const float crumb){
+    const float32x4_t g = vdupq_n_f32(gain), c = vdupq_n_f32(crumb), dB = vdupq_n_f32(TWENTYLOG10OF2);
+    float32x4x2_t ri;
+    float32x4_t amp;
+    int i = begin;
+    for(; i + 4 <= end; i += 4){
+        ri = vld2q_f32(X[i]);
+        amp = sqrtNEON(vmlaq_f32(vmulq_f32(ri.val[0], ri.val[0]), ri.val[1], ri.val[1]));
+        vst1q_f32(magnitudes + i, vmulq_f32(dB, log2NEON(vmlaq_f32(c, amp, g))));
+    }
+    magnitudesScalar(X, magnitudes, i, end, gain, crumb);
+}
+#endif
+
+Kernels select(const simd::ISA cap){
+    Kernels k = {&peakScalar, &amplitudesScalar, &magnitudesScalar, &phasesScalar, &reduceScalar};
+    switch(simd::detect(cap)){
+#if SIMD_HAS_AVX2
+        case simd::ISA::AVX2:
+            k.peak = &peakAVX2;
+            k.amplitudes = &amplitudesAVX2;
+            k.magnitudes = &magnitudesAVX2;
+            k.phases = &phasesAVX2;
+            k.reduce = &reduceAVX2;
+            break;
+#endif
+#if SIMD_X86
+        case simd::ISA::SSE2:
+            k.peak = &peakSSE2;
+            k.amplitudes = &amplitudesSSE2;
+            k.magnitudes = &magnitudesSSE2;
+            k.phases = &phasesSSE2;
+            k.reduce = &reduceSSE2;
+            break;
+#endif
+#if SIMD_NEON
+        case simd::ISA::NEON:
+            k.peak = &peakNEON;
+            k.amplitudes = &amplitudesNEON;
+            k.magnitudes = &magnitudesNEON;
+            k.phases = &phasesNEON;
+            k.reduce = &reduceNEON;
+            break;
+#endif
+        default:
+            break;
+    }
+    return k;
+}
+
+}
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    SpectrumKernels.h
+    Created: 17 Oct 2026 4:36:19am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef SPECTRUMKERNELS_H_INCLUDED
+#define SPECTRUMKERNELS_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "fftw3.h"
+#include "SIMD.h"
+
+//fast approximations used by the FAST spectrum path. both are plain polynomials, so they vectorize without
+//lookup tables. fastLog2 is within 6.5e-6 of log2 for normal positive inputs. what the kernels built on them
+//are held to against libm, over bins spanning 90 dB, on every instruction set (Tests/SpectrumAccuracy.cpp):
+#define FASTPHASEERROR 2.5e-6 //rad, after normalizing to [0, 1)
+#define FASTMAGNITUDEERROR 4.0e-5 //dB
+#define FASTAMPLITUDEERROR 2.5e-7 //relative
+#define ATAN_C1 0.99997726f
+#define ATAN_C3 -0.33262347f
+#define ATAN_C5 0.19354346f
+#define ATAN_C7 -0.11643287f
+#define ATAN_C9 0.05265332f
+#define ATAN_C11 -0.01172120f
+//least squares fit of log2(1 + t) / t on [0, 1)
+#define LOG2_C0 1.44253478f
+#define LOG2_C1 -0.71803359f
+#define LOG2_C2 0.457158121f
+#define LOG2_C3 -0.277341646f
+#define LOG2_C4 0.121472948f
+#define LOG2_C5 -0.0257923451f
+#define TWENTYLOG10OF2 6.0205999f
+
+namespace spectrum{
+    inline float fastAtan2(const float y, const float x){
+        float ax = fabsf(x), ay = fabsf(y), hi = std::max(ax, ay), lo = std::min(ax, ay), a, s, r;
+        a = (hi > 0.0f)?lo / hi:0.0f;
+        s = a * a;
+        r = a * (ATAN_C1 + s * (ATAN_C3 + s * (ATAN_C5 + s * (ATAN_C7 + s * (ATAN_C9 + s * ATAN_C11)))));
+        if(ay > ax){
+            r = (float)(M_PI * 0.5) - r;
+        }
+        if(x < 0.0f){
+            r = (float)M_PI - r;
+        }
+        return std::signbit(y)?-r:r;
+    }
+
+    inline float fastLog2(const float x){//x must be positive and normal
+        uint32_t bits;
+        float m, t;
+        memcpy(&bits, &x, sizeof(float));
+        bits = (bits & 0x007FFFFF) | 0x3F800000;
+        memcpy(&m, &bits, sizeof(float));
+        memcpy(&bits, &x, sizeof(float));
+        t = m - 1.0f;
+        return (float)((int)(bits >> 23) - 127) +
+        t * (LOG2_C0 + t * (LOG2_C1 + t * (LOG2_C2 + t * (LOG2_C3 + t * (LOG2_C4 + t * LOG2_C5)))));
+    }
+
+    //largest |X[i]|^2 over [begin, end), enough to normalize without touching the other spectra
+    typedef float (*PeakKernel)(const fftwf_complex * X, const int begin, const int end);
+    //amplitudes[i] = 2|X[i]| * scale over [begin, end), returns the largest amplitude written
+    typedef float (*AmplitudeKernel)(const fftwf_complex * X, float * amplitudes, const int begin, const int end, const float scale);
+    //magnitudes[i] = 20log10(|X[i]| * gain + crumb), straight from the complex spectrum
+    typedef void (*MagnitudeKernel)(const fftwf_complex * X, float * magnitudes, const int begin, const int end, const float gain, const float crumb);
+    //phases[i] = (atan2(imag, real) + pi) / 2pi, i.e. normalized to [0, 1)
+    typedef void (*PhaseKernel)(const fftwf_complex * X, float * phases, const int begin, const int end);
+    //out[c] = the max (or mean) of x over [edges[c], edges[c + 1]), times scale. a column with no bins of its
+    //own (edges[c + 1] <= edges[c]) gets x[edges[c]], so edges only have to be non decreasing
+    typedef void (*ReduceKernel)(const float * x, const int * edges, float * out, const int numColumns, const float scale, const bool mean);
+
+    struct Kernels{
+        PeakKernel peak;
+        AmplitudeKernel amplitudes;
+        MagnitudeKernel magnitudes;
+        PhaseKernel phases;
+        ReduceKernel reduce;
+    };
+
+    //the FAST path for the widest instruction set available (up to cap)
+    Kernels select(const simd::ISA cap = simd::ISA::AVX2);
+}
+
+#endif  // SPECTRUMKERNELS_H_INCLUDED
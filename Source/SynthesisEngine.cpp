@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    SynthesisEngine.cpp
+    Created: 17 Oct 2026 4:53:46am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "SynthesisEngine.h"
+#include "Instrumentation.h"
+#include <algorithm>
+
+SynthesisEngine::SynthesisEngine(Wavetable<float> * wt, const float sr, const int n, const int hop){
+    size = n;
+    mode = MODE::OSCILLATORS;
+    oscillators = new OscillatorBank();
+    oscillators->init(wt, sr, size);
+    spectral = new SpectralSynthesis(sr, size, hop);
+    noise = new NoiseSynthesis(sr, hop);
+    live = new int[size];
+    nextLive = new int[size];
+    stamps = new uint32_t[size]{0};
+    frameCount = 0;
+    numLive = 0;
+    audible = false;
+    residualLevel = 0.0;
+}
+
+SynthesisEngine::~SynthesisEngine(){
+    delete oscillators;
+    delete spectral;
+    delete noise;
+    delete[] live;
+    delete[] nextLive;
+    delete[] stamps;
+}
+
+void SynthesisEngine::apply(const Frame &frame){
+    int j, k, numNext = 0;
+    bool active;
+    int * swap;
+    frameCount++;
+    for(k = 0; k < frame.numPartials; ++k){
+        const Frame::Partial &partial = frame.partials[k];
+        j = partial.track;
+        if(partial.event == Frame::EVENT::START){
+            oscillators->start(j, partial.amp, partial.frq, partial.phs);
+            spectral->start(j, partial.amp, partial.frq, partial.phs);
+        }
+        else if(partial.event == Frame::EVENT::UPDATE){
+            oscillators->update(j, partial.amp, partial.frq, partial.phs, frame.hopSize);
+            spectral->update(j, partial.amp, partial.frq, partial.phs, frame.hopSize);
+        }
+        active = partial.isActive();
+        oscillators->setActive(j, active);
+        spectral->setActive(j, active);
+        if(active){
+            //output gain only changes at hop boundaries, so it comes in with the frame instead of per sample
+            oscillators->setGain(j, partial.gain);
+            spectral->setGain(j, partial.gain);
+            stamps[j] = frameCount;
+            nextLive[numNext++] = j;
+        }
+    }
+    for(k = 0; k < numLive; ++k){//anything that was sounding and isn't listed any more has stopped
+        j = live[k];
+        if(stamps[j] != frameCount){
+            oscillators->setActive(j, false);
+            spectral->setActive(j, false);
+        }
+    }
+    swap = live;
+    live = nextLive;
+    nextLive = swap;
+    numLive = numNext;
+    audible = frame.activeTracks > 0;
+    noise->setLevels(frame.residual, frame.denormFactor);//the partials carry their own amplitudes, see Frame
+}
+
+int SynthesisEngine::consume(FrameQueue<Frame> &queue){
+    int numApplied = 0;
+    const Frame * frame;
+    while((frame = queue.front()) != nullptr){
+        apply(*frame);
+        queue.pop();
+        numApplied++;
+    }
+    return numApplied;
+}
+
+void SynthesisEngine::render(float * out, const int numSamples){
+    instrumentation::Slot * slot = instrumentation::local();
+    instrumentation::ScopedTimer timer(slot, instrumentation::STAGE::RENDER);
+    instrumentation::count(slot, instrumentation::COUNTER::RENDEREDSAMPLES, numSamples);
+    if(mode == MODE::SPECTRAL){//has to keep pulling grains even when silent, or it would fall behind
+        spectral->render(out, numSamples);
+    }
+    else if(audible){
+        oscillators->render(out, numSamples);
+    }
+    if(!audible){//no active tracks
+        memset(out, 0, sizeof(float) * numSamples);
+    }
+    if(residualLevel > 0.0){
+        noise->render(out, numSamples, residualLevel);
+    }
+}
+
+void SynthesisEngine::setMode(const MODE m){
+    if(m != mode){
+        spectral->reset();//whatever it overlap-added last time it was in use is stale
+        oscillators->settle();//the bank got every frame but rendered none of them, so its ramps never moved
+        mode = m;
+    }
+}
+
+void SynthesisEngine::reset(){
+    for(int k = 0; k < numLive; ++k){
+        oscillators->setActive(live[k], false);
+        spectral->setActive(live[k], false);
+    }
+    spectral->reset();
+    noise->reset();
+    numLive = 0;
+    audible = false;
+}
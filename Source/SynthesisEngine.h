@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    SynthesisEngine.h
+    Created: 17 Oct 2026 4:53:46am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef SYNTHESISENGINE_H_INCLUDED
+#define SYNTHESISENGINE_H_INCLUDED
+
+#include <cstring>
+#include "FrameQueue.h"
+#include "NoiseSynthesis.h"
+#include "OscillatorBank.h"
+#include "SpectralSynthesis.h"
+#include "Track.h"
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  SynthesisEngine Class (renders partial frames)
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//the resynthesis half of the model. it only ever sees Frames, so it doesn't care whether they came from
+//a breakpoint() on this thread, a worker, or somewhere else entirely. nothing here allocates or locks
+//once it's constructed, so it is safe to drive from the audio callback.
+//frames are applied to both the oscillator bank and the spectral synthesis so either can take over at
+//any point, but only the one selected by the mode renders. the residual noise is mixed in on top of
+//either when its level is above 0
+class SynthesisEngine{
+public:
+    enum class MODE{OSCILLATORS, SPECTRAL};
+private:
+    OscillatorBank * oscillators;
+    SpectralSynthesis * spectral;
+    NoiseSynthesis * noise;
+    MODE mode;
+    int * live, * nextLive;//slots left sounding by the last frame, ascending
+    uint32_t * stamps;//frame count at which each slot was last listed as active
+    uint32_t frameCount;
+    int size, numLive;
+    float residualLevel;
+    bool audible;//the last frame had active tracks
+public:
+    SynthesisEngine(Wavetable<float> * wt, const float sr, const int n, const int hop);
+    ~SynthesisEngine();
+
+    //getters
+    int getSize() const{return size;}
+    int getNumActive() const{return numLive;}
+    MODE getMode() const{return mode;}
+
+    //setters
+    void setMode(const MODE m);
+    void setResidualLevel(const float l){residualLevel = l;}//0 (the default) doesn't render any noise at all
+    void setSeed(const uint64_t s){noise->seed(s);}//for the residual noise, not realtime safe
+
+    //business methods
+    void apply(const Frame &frame);//hand a frame's partials to the oscillators, silencing anything it doesn't list
+    int consume(FrameQueue<Frame> &queue);//apply every frame waiting in the queue, in order. returns # applied
+    void render(float * out, const int numSamples);//overwrites out
+    void reset();//silence everything
+};
+
+#endif  // SYNTHESISENGINE_H_INCLUDED
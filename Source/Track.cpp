@@ -9,62 +9,193 @@
 */
 
 #include "Track.h"
-#include "SinusoidalModel.h"
+#include <algorithm>
 
+TrackStore::TrackStore(){
+    amp = frq = phs = nullptr;
+    status = nullptr;
+    active = nullptr;
+    live = born = dead = nullptr;
+    aliveFrames = birthFrames = dyingFrames = nullptr;
+    size = numLive = numBorn = numDead = 0;
+    birthLength = deathLength = 0;
+    longest = 1;
+}
+
+void TrackStore::carve(Arena &a, const int n){
+    //matching reads the live list and amp/frq/phs, updating adds status/active, the rest is rarely touched
+    size = n;
+    live = a.take<int>(size);
+    frq = a.take<float>(size);
+    amp = a.take<float>(size);
+    phs = a.take<float>(size);
+    status = a.take<STATUS>(size);
+    active = a.take<bool>(size);
+    born = a.take<int>(size);
+    dead = a.take<int>(size);
+    aliveFrames = a.take<int>(size);
+    birthFrames = a.take<int>(size);
+    dyingFrames = a.take<int>(size);
+    if(a.isMeasuring()){
+        return;
+    }
+    std::fill(status, status + size, STATUS::DEAD);//tracks are born dead
+    reset();
+}
 
-void Track::init(SinusoidalModel * m){//should only be called on dead tracks
-    assert(status == STATUS::DEAD);
-    status = STATUS::BIRTH;
-    aliveFrames = 0;
-    birthFrames = 0;
-    dyingFrames = 0;
-    model = m;//store pointer to parent model
-    active = false;
+void TrackStore::push(const int j){
+    int i = numDead++, parent;
+    for(; i > 0 && dead[parent = (i - 1) / 2] > j; i = parent){
+        dead[i] = dead[parent];
+    }
+    dead[i] = j;
+}
+
+int TrackStore::pop(){
+    int top = dead[0], last = dead[--numDead], i = 0, child;
+    for(; (child = 2 * i + 1) < numDead; i = child){
+        if(child + 1 < numDead && dead[child + 1] < dead[child]){
+            child++;
+        }
+        if(last <= dead[child]){
+            break;
+        }
+        dead[i] = dead[child];
+    }
+    dead[i] = last;
+    return top;
 }
 
+void TrackStore::reset(){
+    numLive = numBorn = numDead = 0;
+    for(int j = 0; j < size; ++j){//ascending, so the heap is already in order
+        if(status[j] == STATUS::DEAD){
+            dead[numDead++] = j;
+        }
+        else{
+            live[numLive++] = j;
+        }
+    }
+}
 
-void Track::update(const bool matched, const float a, const float f, const float p){//should never be called on dead tracks
-    assert(status != STATUS::DEAD);
+int TrackStore::birth(){
+    int j;
+    if(numDead == 0){
+        return -1;
+    }
+    j = pop();
+    born[numBorn++] = j;
+    restart(j);
+    return j;
+}
+
+void TrackStore::restart(const int j){
+    status[j] = STATUS::BIRTH;
+    aliveFrames[j] = 0;
+    birthFrames[j] = 0;
+    dyingFrames[j] = 0;
+    active[j] = false;
+}
+
+void TrackStore::update(const int j, const bool matched, const float a, const float f, const float p){//should never be called on dead tracks
+    assert(status[j] != STATUS::DEAD);
     if(matched){//continuing track
-        amp = a, frq = f, phs = p;
-        if(status == STATUS::BIRTH){//birthing
-            birthFrames++;
-            if(birthFrames >= model->trackBirth){
-                status = STATUS::ALIVE;
+        amp[j] = a, frq[j] = f, phs[j] = p;
+        if(status[j] == STATUS::BIRTH){//birthing
+            birthFrames[j]++;
+            if(birthFrames[j] >= birthLength){
+                status[j] = STATUS::ALIVE;
             }
         }
-        else if(status == STATUS::DYING){//revived
-            status = STATUS::ALIVE;
-            dyingFrames = 0;
+        else if(status[j] == STATUS::DYING){//revived
+            status[j] = STATUS::ALIVE;
+            dyingFrames[j] = 0;
         }
-        aliveFrames++;
-		if(aliveFrames > model->longestTrack){
-			model->longestTrack = aliveFrames;
+        aliveFrames[j]++;
+		if(aliveFrames[j] > longest){
+			longest = aliveFrames[j];
 		}
     }
     else{//in limbo
-        if(status == STATUS::BIRTH){//birth failed
-            status = STATUS::DEAD;
+        if(status[j] == STATUS::BIRTH){//birth failed
+            status[j] = STATUS::DEAD;
         }
-        else if(status == STATUS::DYING){//condition not improving
-            dyingFrames++;
-            if(dyingFrames >= model->trackDeath){//it's bleedin' demised
-                status = STATUS::DEAD;
-                aliveFrames = 0;
+        else if(status[j] == STATUS::DYING){//condition not improving
+            dyingFrames[j]++;
+            if(dyingFrames[j] >= deathLength){//it's bleedin' demised
+                status[j] = STATUS::DEAD;
+                aliveFrames[j] = 0;
             }
         }
-        else if(status == STATUS::ALIVE){//initial signs of decay
-            status = STATUS::DYING;
+        else if(status[j] == STATUS::ALIVE){//initial signs of decay
+            status[j] = STATUS::DYING;
         }
     }
     //using 'active' as an optimization to reduce comparisons
-    if(status == STATUS::BIRTH || status == STATUS::DEAD){
-        active = false;
+    active[j] = (status[j] == STATUS::ALIVE || status[j] == STATUS::DYING);
+}
+
+void TrackStore::admit(){
+    int i, k, n;
+    if(numBorn == 0){
+        return;
     }
-    else{
-        active = true;
+    //merge from the back, both lists are ascending and live has room for all of them
+    i = numLive - 1;
+    k = numBorn - 1;
+    for(n = numLive + numBorn - 1; k >= 0; --n){
+        live[n] = (i >= 0 && live[i] > born[k])?live[i--]:born[k--];
     }
+    numLive += numBorn;
+    numBorn = 0;
+}
+
+void TrackStore::retire(){
+    int i, n = 0;
+    for(i = 0; i < numLive; ++i){
+        if(status[live[i]] == STATUS::DEAD){
+            push(live[i]);
+        }
+        else{
+            live[n++] = live[i];
+        }
+    }
+    numLive = n;
+}
+
+bool matchSort(const TrackMatch &a, const TrackMatch &b){
+	float frqDiffA = a.frqDiff, frqDiffB = b.frqDiff;
+	if(frqDiffA == frqDiffB){//if tied, sort by overall distanceSq
+		return a.distSq < b.distSq;
+	}
+	return frqDiffA < frqDiffB;//otherwise sort by frqDiff
+}
+
+void findCandidates(const TrackStore &tracks, const Peak * peaks, const int numPeaks, const float * frequencyThresholds,
+                    TrackMatch * candidates){
+    float lookupAmp, lookupFrq, lookupPhs, frqDiff, frqThreshold;
+    int i, j, k, nearest, numLive = tracks.getNumLive();
+    TrackMatch match;
+	//the closest peak to a track is one of the two either side of its frequency. matchSort ranks by frqDiff
+	//first, so only those two (tested low then high, as a full scan would) can ever win
+	for(i = 0; i < numLive; ++i){//looping over living or limbo tracks, in ascending order
+		j = tracks.getLive(i);
+		candidates[j].reset();
+		lookupAmp = tracks.getAmp(j);
+		lookupFrq = tracks.getFrq(j);
+		lookupPhs = tracks.getPhs(j);
+		frqThreshold = frequencyThresholds[(int)lookupFrq];
+		nearest = (int)(std::lower_bound(peaks, peaks + numPeaks, lookupFrq, Peak::below) - peaks);
+		for(k = std::max(nearest - 1, 0); k <= nearest && k < numPeaks; ++k){//looping over neighbouring detections
+			frqDiff = fabs(lookupFrq - peaks[k].frq);//need abs for comparisons
+			if(frqDiff < frqThreshold){//potential match here
+				//test against current best match
+				match.init(k, true, peaks[k].amp, peaks[k].frq, peaks[k].phs);
+				match.setDistanceSq(lookupAmp, lookupFrq, lookupPhs);
+				if(matchSort(match, candidates[j])){
+					candidates[j] = match;
+				}
+			}
+		}
+	}
 }
-const bool Track::isDead(void) const{
-    return (status == STATUS::DEAD)?true:false;
-}
\ No newline at end of file
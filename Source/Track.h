@@ -12,34 +12,80 @@
 #define TRACK_H_INCLUDED
 #include <cmath>
 
-class SinusoidalModel;
+#include <algorithm>
+#include <cassert>
+#include "Arena.h"
+#include "Residual.h"
 
-class Track{
-friend class SinusoidalModel;
+//////////////////////////////////////////////////////////////
+//  TrackStore (every track's state, as parallel arrays)
+//////////////////////////////////////////////////////////////
+//the fields a hop reads (amp, frq, phs, status, active) sit in their own arrays, away from the frame
+//counters. live tracks (anything not DEAD) are kept in a dense ascending index list, so matching and
+//updating walk only those, in the same order a full scan would. dead indices sit in a min heap, so
+//births still take the lowest dead index first
+class TrackStore{
 public:
     enum class STATUS{BIRTH, ALIVE, DYING, DEAD};
 private:
-    float amp, frq, phs;
-    STATUS status;
-    int aliveFrames, birthFrames, dyingFrames;
-    SinusoidalModel * model;
+    float * amp, * frq, * phs;
+    STATUS * status;
+    bool * active;//ALIVE or DYING, i.e. sounding
+    int * live;//ascending
+    int * born;//started since the last admit(), ascending since they come off the heap in order
+    int * dead;//min heap
+    int * aliveFrames, * birthFrames, * dyingFrames;
+    int size, numLive, numBorn, numDead, birthLength, deathLength, longest;
+
+    void push(const int j);
+    int pop();
 public:
-    bool active;
-    Track(){
-        status = STATUS::DEAD;
-        active = false;
-        model = nullptr;
-    };
-    ~Track(){
-        model = nullptr;
-    };
-    
-    void init(SinusoidalModel * m/*, const float a, const float f, const float p*/);//should only be called on dead tracks, tracks are born dead
-    
-    void update(const bool matched, const float a = 0, const float f = 0, const float p = 0);//should not be called on dead tracks
+    TrackStore();
+    void carve(Arena &a, const int n);//n tracks, all of them dead until reset()
+
+    //getters
+    int getSize() const{return size;}
+    int getNumLive() const{return numLive;}
+    int getLive(const int i) const{return live[i];}
+    int getLongest() const{return longest;}//most frames any track matched in this hop has lived
+    float getAmp(const int j) const{return amp[j];}
+    float getFrq(const int j) const{return frq[j];}
+    float getPhs(const int j) const{return phs[j];}
+    STATUS getStatus(const int j) const{return status[j];}
+    int getAliveFrames(const int j) const{return aliveFrames[j];}
+    bool isActive(const int j) const{return active[j];}
+    bool isDead(const int j) const{return status[j] == STATUS::DEAD;}
+
+    //setters
+    void setLifetimes(const int b, const int d){birthLength = b; deathLength = d;}//frames to be born, frames to die
+    void resetLongest(){longest = 1;}
 
-    //const bool isActive(void) const;
-    const bool isDead(void) const;
+    void reset();//rebuild the live list and dead heap from the statuses, tracks themselves carry on
+    int birth();//start the lowest dead track, -1 if there isn't one
+    void restart(const int j);//start j over whatever it was doing (stealing), stays live
+    void update(const int j, const bool matched, const float a = 0, const float f = 0, const float p = 0);//not on dead tracks
+    //end of hop bookkeeping, around a pass over getLive(): admit() merges this hop's births into the live list,
+    //retire() drops whatever died during the pass and hands its index back to the heap
+    void admit();
+    void retire();
+};
+
+class Peak{
+//spectral peak picked out of one analysis frame
+public:
+	int bin;
+	bool assigned;
+	float amp, frq, phs;
+	void init(const int b, const float a, const float f, const float p){
+		bin = b;
+		assigned = false;
+		amp = a;
+		frq = f;
+		phs = p;
+	}
+	static bool below(const Peak &peak, const float f){//for searching the frequency-ordered peak list
+		return peak.frq < f;
+	}
 };
 
 class TrackMatch{
@@ -73,5 +119,64 @@ public:
 	}
 };
 
+bool matchSort(const TrackMatch &a, const TrackMatch &b);//a is the better match: nearer in frequency, then overall
+//every live track's best peak within frequencyThresholds[(int)frq] of it, idx -1 if there isn't one. peaks in
+//ascending frequency order, as detection leaves them
+void findCandidates(const TrackStore &tracks, const Peak * peaks, const int numPeaks, const float * frequencyThresholds,
+                    TrackMatch * candidates);
+
+class Frame{
+//one breakpoint()'s worth of partials: every track that is sounding or had an event since the last frame, in
+//ascending track order. tracks not listed are silent, but START and UPDATE only come in the frame they happen
+//in, so frames have to be applied in order. a consumer that skips some has to restart whatever is sounding
+//(see PartialPlayer), and a model that can't write one holds its events over to the next.
+//amplitudes are the sinusoids' own, so they ramp smoothly from one frame to the next. denormFactor is the
+//frame's loudest bin and only scales the residual (see Residual.h)
+public:
+	enum class EVENT{NONE, START, UPDATE};
+	struct Partial{
+		int track;
+		EVENT event;
+		TrackStore::STATUS status;
+		float amp, frq, phs, gain;
+		bool isActive() const{//same rule as TrackStore::isActive
+			return status == TrackStore::STATUS::ALIVE || status == TrackStore::STATUS::DYING;
+		}
+	};
+	Partial * partials;
+	int capacity, numPartials, hopSize, activeTracks, index;//index: hops since the model's init(), so gaps show
+	float denormFactor;
+	float residual[RESIDUALBANDS];//what the partials leave out, all 0 unless the model estimates it. see Residual.h
+	Frame(const int n){
+		capacity = n;
+		partials = new Partial[capacity];
+		numPartials = hopSize = activeTracks = index = 0;
+		denormFactor = 0.0;
+		std::fill(residual, residual + RESIDUALBANDS, 0.0f);
+	}
+	~Frame(){
+		delete[] partials;
+	}
+	void add(const int j, const EVENT e, const TrackStore::STATUS s, const float a, const float f, const float p, const float g){
+		Partial &partial = partials[numPartials++];
+		partial.track = j;
+		partial.event = e;
+		partial.status = s;
+		partial.amp = a;
+		partial.frq = f;
+		partial.phs = p;
+		partial.gain = g;
+	}
+	void copy(const Frame &f){//no allocation, partials past our capacity are dropped
+		numPartials = (f.numPartials < capacity)?f.numPartials:capacity;
+		std::copy(f.partials, f.partials + numPartials, partials);
+		hopSize = f.hopSize;
+		activeTracks = f.activeTracks;
+		index = f.index;
+		denormFactor = f.denormFactor;
+		std::copy(f.residual, f.residual + RESIDUALBANDS, residual);
+	}
+};
+
 
 #endif  // TRACK_H_INCLUDED
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 17 Oct 2026 6:07:53am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef TRIPLEBUFFER_H_INCLUDED
+#define TRIPLEBUFFER_H_INCLUDED
+
+#include <atomic>
+
+//lock-free single producer/single consumer "latest value" channel. the producer fills the slot write() hands it
+//and publishes it with one atomic exchange, the consumer takes the newest published slot with update() and
+//reads it in place until its next update(). neither side ever waits or sees a half written slot, and frames
+//the consumer didn't get to in time are simply overwritten. T needs a constructor taking the slot capacity
+template <class T>
+class TripleBuffer {
+private:
+    enum{FRESH = 4};//set on middle while it holds something the consumer hasn't taken
+    T * slots[3];
+    std::atomic<int> middle;//the slot between the two sides
+    int back, front;//owned by the producer and the consumer
+public:
+    TripleBuffer(const int capacity){
+        for(int i = 0; i < 3; ++i){
+            slots[i] = new T(capacity);
+        }
+        back = 0;
+        middle.store(1);
+        front = 2;
+    }
+    ~TripleBuffer(){
+        for(int i = 0; i < 3; ++i){
+            delete slots[i];
+        }
+    }
+    //producer
+    T * write(){//always the same slot until publish()
+        return slots[back];
+    }
+    void publish(){
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    }
+    bool isPending() const{//the consumer hasn't taken the last one, so there's no hurry to publish another
+        return (middle.load(std::memory_order_relaxed) & FRESH) != 0;
+    }
+    //consumer
+    bool update(){//true if read() has moved on to a newer slot
+        if(!(middle.load(std::memory_order_relaxed) & FRESH)){
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+        return true;
+    }
+    const T & read() const{
+        return *slots[front];
+    }
+};
+
+#endif  // TRIPLEBUFFER_H_INCLUDED
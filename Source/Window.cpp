@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    Window.cpp
+    Created: 17 Oct 2026 6:55:04am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#include "Window.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace{
+    //four term cosine sums: a0 - a1 cos(x) + a2 cos(2x) - a3 cos(3x)
+    const double hann[4] = {0.5, 0.5, 0.0, 0.0};
+    const double blackmanHarris[4] = {0.35875, 0.48829, 0.14128, 0.01168};
+    const double nuttall[4] = {0.355768, 0.487396, 0.144232, 0.012604};//continuous first derivative
+
+    void cosineSum(const double * a, float * w, float * dw, const int n){
+        double x;
+        for(int i = 0; i < n; ++i){
+            x = 2.0 * M_PI * i / n;
+            w[i] = (float)(a[0] - a[1] * cos(x) + a[2] * cos(2.0 * x) - a[3] * cos(3.0 * x));
+            dw[i] = (float)(2.0 * M_PI / n * (a[1] * sin(x) - 2.0 * a[2] * sin(2.0 * x) + 3.0 * a[3] * sin(3.0 * x)));
+        }
+    }
+
+    //power series for I0(x) and I1(x) / x, both fine for the arguments a Kaiser window needs
+    double besselI0(const double x){
+        double sum = 1.0, term = 1.0, q = 0.25 * x * x;
+        for(int k = 1; term > 1e-12 * sum; ++k){
+            term *= q / ((double)k * k);
+            sum += term;
+        }
+        return sum;
+    }
+    double besselI1OverX(const double x){
+        double sum = 0.5, term = 0.5, q = 0.25 * x * x;
+        for(int k = 1; term > 1e-12 * sum; ++k){
+            term *= q / ((double)k * (k + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    //|W(offset)| / W(0), offset in bins of a paddedSize FFT. summed with a rotating phasor, in double
+    double response(const float * w, const int n, const int paddedSize, const double offset){
+        double re = 0.0, im = 0.0, sum = 0.0, t, rotRe = cos(2.0 * M_PI * offset / paddedSize), rotIm = -sin(2.0 * M_PI * offset / paddedSize),
+        phRe = 1.0, phIm = 0.0;
+        for(int i = 0; i < n; ++i){
+            re += w[i] * phRe;
+            im += w[i] * phIm;
+            sum += w[i];
+            t = phRe * rotRe - phIm * rotIm;
+            phIm = phRe * rotIm + phIm * rotRe;
+            phRe = t;
+        }
+        return sqrt(re * re + im * im) / sum;
+    }
+
+    double decibels(const double x){
+        return 20.0 * log10(x + 1e-12);
+    }
+}
+
+namespace windows{
+    const char * getName(const TYPE t){
+        switch(t){
+            case TYPE::HANN:
+                return "hann";
+            case TYPE::GAUSSIAN:
+                return "gaussian";
+            case TYPE::BLACKMANHARRIS:
+                return "blackman-harris";
+            case TYPE::KAISER:
+                return "kaiser";
+            case TYPE::NUTTALL:
+                return "nuttall";
+            default:
+                return "unknown";
+        }
+    }
+
+    void fill(const TYPE t, float * w, float * dw, const int n){
+        double sigma = n / 8.0, u, r, i0 = besselI0(KAISERBETA);
+        int i;
+        switch(t){
+            case TYPE::HANN:
+                cosineSum(hann, w, dw, n);
+                break;
+            case TYPE::GAUSSIAN://4 sigma either side of the middle
+                for(i = 0; i < n; ++i){
+                    u = i - 0.5 * n;
+                    w[i] = (float)exp(-u * u / (2.0 * sigma * sigma));
+                    dw[i] = (float)(-u / (sigma * sigma) * w[i]);
+                }
+                break;
+            case TYPE::BLACKMANHARRIS:
+                cosineSum(blackmanHarris, w, dw, n);
+                break;
+            case TYPE::KAISER:
+                for(i = 0; i < n; ++i){
+                    u = 2.0 * i / n - 1.0;
+                    r = sqrt(std::max(1.0 - u * u, 0.0));
+                    w[i] = (float)(besselI0(KAISERBETA * r) / i0);
+                    //d/di I0(beta r) = beta^2 I1(beta r) / (beta r) * r dr/di, and r dr/di = -u 2 / n
+                    dw[i] = (float)(KAISERBETA * KAISERBETA * besselI1OverX(KAISERBETA * r) * -u * 2.0 / n / i0);
+                }
+                break;
+            case TYPE::NUTTALL:
+                cosineSum(nuttall, w, dw, n);
+                break;
+            default:
+                for(i = 0; i < n; ++i){
+                    w[i] = 1.0f;
+                    dw[i] = 0.0f;
+                }
+                break;
+        }
+    }
+
+    void measure(const float * w, const int n, const int paddedSize, Table &table){
+        const int numScan = LOBESCANBINS * LOBESCANPOINTS, numFine = 4 * BIASPOINTS;
+        double sum = 0.0, step = (double)paddedSize / n / LOBESCANPOINTS, previous, current, highest, a, b, c, p, delta;
+        std::vector<double> estimates(numFine), frequencyErrors(numFine), magnitudeErrors(numFine);
+        int i, j;
+        for(i = 0; i < n; ++i){
+            sum += w[i];
+        }
+        table.coherentGain = (float)(sum / n);
+        for(i = 0; i < LOBEBINS * WINDOWLOBEOVERSAMPLING + 2; ++i){
+            table.lobe[i] = (float)response(w, n, paddedSize, (double)i / WINDOWLOBEOVERSAMPLING);
+        }
+        //main lobe out to where the response first turns back up, the sidelobes are the loudest point after that
+        previous = 1.0;
+        for(i = 1; i <= numScan; ++i){
+            current = response(w, n, paddedSize, i * step);
+            if(current > previous){
+                break;
+            }
+            previous = current;
+        }
+        table.mainLobeWidth = (float)((i - 1) * step);
+        highest = previous;
+        for(; i <= numScan; ++i){
+            highest = std::max(highest, response(w, n, paddedSize, i * step));
+        }
+        table.sidelobeLevel = (float)decibels(highest);
+        //what parabolic interpolation makes of a sinusoid delta bins above the peak bin, delta from 0 to 0.5
+        for(i = 0; i < numFine; ++i){
+            delta = 0.5 * i / (numFine - 1);
+            a = decibels(response(w, n, paddedSize, 1.0 + delta));
+            b = decibels(response(w, n, paddedSize, delta));
+            c = decibels(response(w, n, paddedSize, 1.0 - delta));
+            p = (a + c - 2.0 * b < 0.0)?0.5 * (a - c) / (a + c - 2.0 * b):0.0;
+            estimates[i] = p;
+            frequencyErrors[i] = delta - p;
+            magnitudeErrors[i] = -(b - 0.25 * (a - c) * p);
+        }
+        //turned around, so the tables are indexed by the estimate
+        for(i = 0, j = 0; i < BIASPOINTS; ++i){
+            p = 0.5 * i / (BIASPOINTS - 1);
+            while(j < numFine - 2 && estimates[j + 1] < p){
+                j++;
+            }
+            delta = (estimates[j + 1] > estimates[j])?(p - estimates[j]) / (estimates[j + 1] - estimates[j]):0.0;
+            delta = std::min(std::max(delta, 0.0), 1.0);
+            table.frequencyBias[i] = (float)(frequencyErrors[j] + delta * (frequencyErrors[j + 1] - frequencyErrors[j]));
+            table.magnitudeBias[i] = (float)(magnitudeErrors[j] + delta * (magnitudeErrors[j + 1] - magnitudeErrors[j]));
+        }
+    }
+
+    float Table::getLobeGain(const float offset) const{
+        float position = std::min(fabsf(offset), (float)LOBEBINS) * WINDOWLOBEOVERSAMPLING, fraction = position - (int)position;
+        return lobe[(int)position] + fraction * (lobe[(int)position + 1] - lobe[(int)position]);
+    }
+
+    void Table::correct(const float estimate, float &offset, float &dB) const{
+        float position = std::min(fabsf(estimate), 0.5f) * 2.0f * (BIASPOINTS - 1), fraction;
+        int i = std::min((int)position, BIASPOINTS - 2);
+        fraction = position - i;
+        offset = frequencyBias[i] + fraction * (frequencyBias[i + 1] - frequencyBias[i]);
+        offset = (estimate < 0.0f)?estimate - offset:estimate + offset;
+        dB = magnitudeBias[i] + fraction * (magnitudeBias[i + 1] - magnitudeBias[i]);
+    }
+}
@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    Window.h
+    Created: 17 Oct 2026 6:55:04am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+#ifndef WINDOW_H_INCLUDED
+#define WINDOW_H_INCLUDED
+
+#define WINDOWLOBEOVERSAMPLING 64 //Table::lobe points per bin
+#define LOBEBINS 2 //bins out Table::lobe reaches, past any offset an estimator can produce
+#define BIASPOINTS 33 //Table's parabolic corrections, for estimates from 0 to 0.5 bins
+#define LOBESCANPOINTS 8 //per unpadded bin, looking for the first null and the sidelobes
+#define LOBESCANBINS 16 //unpadded bins out to look
+#define KAISERBETA 9.0 //pi * alpha. about -66 dB sidelobes for a main lobe 3 bins either side
+
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//  Analysis windows
+//////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////
+//every window is the periodic form (symmetric about n / 2, the way an FFT sees it) and comes with its
+//derivative for reassignment. what peak picking needs to know about one is measured from the window itself
+//at the size and padding it's used with, so nothing has to be kept in step by hand
+namespace windows{
+    enum class TYPE{HANN, GAUSSIAN, BLACKMANHARRIS, KAISER, NUTTALL};
+    static const int numTypes = 5;
+
+    //bins are the padded FFT's throughout
+    struct Table{
+        float lobe[LOBEBINS * WINDOWLOBEOVERSAMPLING + 2];//|W(offset)| / W(0), from offset 0 in 1 / WINDOWLOBEOVERSAMPLING steps
+        float frequencyBias[BIASPOINTS];//true offset minus the parabolic estimate, for estimates 0 to 0.5
+        float magnitudeBias[BIASPOINTS];//dB the parabolic peak magnitude reads low by, same estimates
+        float coherentGain;//sum(w) / n
+        float mainLobeWidth;//from the centre to the first null
+        float sidelobeLevel;//dB, the highest sidelobe scanned relative to the main lobe's peak
+
+        float getLobeGain(const float offset) const;//1 at 0, clamped at LOBEBINS
+        //parabolic interpolation on dB magnitudes pulls towards the bin and reads low, by amounts that depend
+        //only on the window. estimate in bins either side, offset comes back the same way
+        void correct(const float estimate, float &offset, float &dB) const;
+    };
+
+    const char * getName(const TYPE t);
+    void fill(const TYPE t, float * w, float * dw, const int n);//n points of the window and of dw/dn
+    void measure(const float * w, const int n, const int paddedSize, Table &table);//not realtime safe, a few hundred DFT bins of w
+}
+
+#endif  // WINDOW_H_INCLUDED
@@ -0,0 +1,270 @@
+/*
+  ==============================================================================
+
+    PartialFiles.cpp
+    Created: 17 Oct 2026 9:02:07am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+//checks what PartialWriter puts on disk: an SMPF file has to read back through PartialReader exactly as it was
+//written, across chunks, and the SDIF file is walked byte by byte against the 1TRC layout, with phases in radians
+//and a new partial index for every birth even when a track slot is reused. exits nonzero on any failure
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "PartialReader.h"
+#include "PartialWriter.h"
+
+#define SAMPLERATE 44100
+#define WINDOWSIZE 1024
+#define HOPSIZE 256
+#define NUMTRACKS 12
+#define NUMFRAMES (2 * PARTIALCHUNKFRAMES + 100) //three chunks, the last one part full
+#define GAPFRAME 300 //the frame after which a few hops are missing
+#define GAPHOPS 3
+#define SDIFPATH "partial-files-test.sdif"
+#define SMPFPATH "partial-files-test.smpf"
+
+static int numFailures = 0;
+
+static void check(const char * what, const double value, const double bound){
+    if(!(value < bound)){
+        std::cout << "Error: " << what << " " << value << " (bound " << bound << ")" << std::endl;
+        numFailures++;
+    }
+}
+
+//tracks coming and going in a small set of slots, so every slot gets reused. some births spend a frame in BIRTH,
+//listed with their START but not sounding yet, and every death is a couple of DYING frames
+static void makeFrames(std::vector<Frame *> &frames){
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> lifetime(1, 30);
+    std::vector<int> life(NUMTRACKS, 0), dying(NUMTRACKS, 0);
+    std::vector<bool> born(NUMTRACKS, false);
+    int k, j, index = 0, active;
+    for(k = 0; k < NUMFRAMES; ++k){
+        Frame * f = new Frame(NUMTRACKS);
+        active = 0;
+        for(j = 0; j < NUMTRACKS; ++j){
+            float amp = unit(rng), frq = 50.0f + 10000.0f * unit(rng), phs = unit(rng), gain = unit(rng);
+            if(life[j] == 0 && dying[j] == 0 && !born[j]){//dead
+                if(unit(rng) < 0.15f){
+                    if(unit(rng) < 0.3f){//one frame in BIRTH first
+                        f->add(j, Frame::EVENT::START, TrackStore::STATUS::BIRTH, amp, frq, phs, 0.0f);
+                        born[j] = true;
+                    }
+                    else{
+                        f->add(j, Frame::EVENT::START, TrackStore::STATUS::ALIVE, amp, frq, phs, gain);
+                        life[j] = lifetime(rng);
+                        active++;
+                    }
+                }
+            }
+            else if(born[j]){
+                f->add(j, Frame::EVENT::UPDATE, TrackStore::STATUS::ALIVE, amp, frq, phs, gain);
+                born[j] = false;
+                life[j] = lifetime(rng);
+                active++;
+            }
+            else if(life[j] > 0){
+                f->add(j, Frame::EVENT::UPDATE, TrackStore::STATUS::ALIVE, amp, frq, phs, gain);
+                if(--life[j] == 0){
+                    dying[j] = 2;
+                }
+                active++;
+            }
+            else{//sounding on, unmatched, then gone
+                f->add(j, Frame::EVENT::NONE, TrackStore::STATUS::DYING, amp, frq, phs, gain);
+                dying[j]--;
+                active++;
+            }
+        }
+        f->index = index;
+        f->hopSize = HOPSIZE;
+        f->activeTracks = active;
+        f->denormFactor = unit(rng);
+        frames.push_back(f);
+        index += (k == GAPFRAME)?1 + GAPHOPS:1;
+    }
+}
+
+static bool write(const std::vector<Frame *> &frames){
+    PartialWriter writer(NUMTRACKS, SAMPLERATE, WINDOWSIZE, HOPSIZE);
+    int k;
+    if(!writer.open(SDIFPATH, SMPFPATH)){
+        std::cout << "Error: couldn't open the test files for writing" << std::endl;
+        return false;
+    }
+    for(k = 0; k < (int)frames.size(); ++k){
+        if(k % 16 == 15){//the writer thread only polls every few ms, give it a chance to keep up
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        while(!writer.push(*frames[k])){//and if it still hasn't, nothing is skipped, so no gaps
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    if(!writer.close() || writer.getNumFrames() != (int)frames.size()){
+        std::cout << "Error: writer reported a failure, or wrote " << writer.getNumFrames() << " of " << frames.size() << " frames" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////
+//  SMPF
+//////////////////////////////////////////////////////////////
+static void checkSMPF(const std::vector<Frame *> &frames){
+    PartialReader reader;
+    Frame f(NUMTRACKS);
+    long differences = 0;
+    int k, i;
+    if(!reader.open(SMPFPATH)){
+        std::cout << "Error: couldn't read " << SMPFPATH << " back" << std::endl;
+        numFailures++;
+        return;
+    }
+    check("smpf header", fabs(reader.getSamplingRate() - SAMPLERATE) + abs(reader.getWindowSize() - WINDOWSIZE) +
+          abs(reader.getHopSize() - HOPSIZE) + abs(reader.getMaxTracks() - NUMTRACKS), 1.0e-9);
+    check("smpf frames missing or extra", abs(reader.getNumFrames() - (int)frames.size()), 1);
+    for(k = 0; k < (int)frames.size() && k < reader.getNumFrames(); ++k){
+        const Frame &e = *frames[k];
+        if(!reader.read(k, f) || f.index != e.index || f.hopSize != e.hopSize || f.activeTracks != e.activeTracks ||
+           f.denormFactor != e.denormFactor || f.numPartials != e.numPartials || reader.getIndex(k) != e.index ||
+           reader.find(e.index) != k){
+            differences++;
+            continue;
+        }
+        for(i = 0; i < e.numPartials; ++i){
+            const Frame::Partial &a = f.partials[i], &b = e.partials[i];
+            differences += a.track != b.track || a.event != b.event || a.status != b.status || a.amp != b.amp ||
+                           a.frq != b.frq || a.phs != b.phs || a.gain != b.gain;
+        }
+    }
+    check("smpf frames or partials read back differently", differences, 1);
+    reader.close();
+}
+
+//////////////////////////////////////////////////////////////
+//  SDIF
+//////////////////////////////////////////////////////////////
+static uint32_t getBig(const std::vector<unsigned char> &b, const size_t at){
+    return ((uint32_t)b[at] << 24) | ((uint32_t)b[at + 1] << 16) | ((uint32_t)b[at + 2] << 8) | b[at + 3];
+}
+static float getBigFloat(const std::vector<unsigned char> &b, const size_t at){
+    uint32_t x = getBig(b, at);
+    float f;
+    memcpy(&f, &x, 4);
+    return f;
+}
+static double getBigDouble(const std::vector<unsigned char> &b, const size_t at){
+    uint64_t x = ((uint64_t)getBig(b, at) << 32) | getBig(b, at + 4);
+    double d;
+    memcpy(&d, &x, 8);
+    return d;
+}
+
+static void checkSDIF(const std::vector<Frame *> &frames){
+    std::vector<unsigned char> b;
+    std::vector<int> ids(NUMTRACKS, -1);
+    FILE * file = fopen(SDIFPATH, "rb");
+    size_t at = 16, size;
+    long layout = 0, rowErrors = 0, numRows = 0, numReused = 0;
+    int k, i, rows, nextID = 0, lastIndex = -1;
+    double time, maxPhase = 0.0;
+    if(file == nullptr){
+        std::cout << "Error: couldn't read " << SDIFPATH << " back" << std::endl;
+        numFailures++;
+        return;
+    }
+    for(int c; (c = fgetc(file)) != EOF;){
+        b.push_back((unsigned char)c);
+    }
+    fclose(file);
+    //file header: SDIF, 8 bytes of it left, spec version 3, standard types version 1
+    if(b.size() < 16 || memcmp(&b[0], "SDIF", 4) != 0 || getBig(b, 4) != 8 || getBig(b, 8) != 3 || getBig(b, 12) != 1){
+        std::cout << "Error: bad SDIF file header" << std::endl;
+        numFailures++;
+        return;
+    }
+    for(k = 0; k < (int)frames.size(); ++k){
+        const Frame &e = *frames[k];
+        if(e.index != lastIndex + 1){//the writer can't tell a gap from lost STARTs, so it starts everything over
+            std::fill(ids.begin(), ids.end(), -1);
+        }
+        lastIndex = e.index;
+        for(i = rows = 0; i < e.numPartials; ++i){
+            const Frame::Partial &p = e.partials[i];
+            if(p.event == Frame::EVENT::START || ids[p.track] < 0){
+                numReused += p.event == Frame::EVENT::START && ids[p.track] >= 0;
+                ids[p.track] = nextID++;
+            }
+            rows += p.isActive();
+        }
+        //frame header (signature, size of the rest, time, stream, one matrix), then the matrix header (signature,
+        //float32, rows, 4 columns) and the rows. 16 byte rows never need padding out to 8
+        size = 16 + 16 + 16 * rows;
+        if(at + 8 + size > b.size()){
+            layout++;
+            break;
+        }
+        time = (WINDOWSIZE / 2 + (double)e.index * HOPSIZE) / SAMPLERATE;
+        layout += memcmp(&b[at], "1TRC", 4) != 0 || getBig(b, at + 4) != size || getBigDouble(b, at + 8) != time ||
+                  getBig(b, at + 16) != 0 || getBig(b, at + 20) != 1 || memcmp(&b[at + 24], "1TRC", 4) != 0 ||
+                  getBig(b, at + 28) != 0x0004 || getBig(b, at + 32) != (uint32_t)rows || getBig(b, at + 36) != 4;
+        at += 40;
+        for(i = 0; i < e.numPartials; ++i){//index, frequency, amplitude, phase
+            const Frame::Partial &p = e.partials[i];
+            if(!p.isActive()){
+                continue;
+            }
+            rowErrors += getBigFloat(b, at) != (float)ids[p.track] || getBigFloat(b, at + 4) != p.frq ||
+                         getBigFloat(b, at + 8) != p.amp * p.gain;
+            maxPhase = std::max(maxPhase, fabs(getBigFloat(b, at + 12) - (2.0 * M_PI * p.phs - M_PI)));
+            numRows++;
+            at += 16;
+        }
+    }
+    std::cout << "sdif: " << k << " frames, " << numRows << " rows, " << nextID << " partials, " << numReused
+              << " of them in a reused slot" << std::endl;
+    check("sdif frame layout errors", layout, 1);
+    check("sdif bytes left over", (double)(b.size() - at), 1);
+    check("sdif rows with the wrong index, frequency or amplitude", rowErrors, 1);
+    check("sdif phase error, rad", maxPhase, 1.0e-6);
+    if(numReused == 0){//the point of the partial index
+        std::cout << "Error: no track slot was reused" << std::endl;
+        numFailures++;
+    }
+}
+
+int main(){
+    std::vector<Frame *> frames;
+    makeFrames(frames);
+    if(write(frames)){
+        checkSMPF(frames);
+        checkSDIF(frames);
+    }
+    else{
+        numFailures++;
+    }
+    for(Frame * f : frames){
+        delete f;
+    }
+    remove(SDIFPATH);
+    remove(SMPFPATH);
+    if(numFailures > 0){
+        std::cout << numFailures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
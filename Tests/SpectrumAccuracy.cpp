@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    SpectrumAccuracy.cpp
+    Created: 17 Oct 2026 7:11:41am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+//checks the FAST spectrum path against EXACT: every kernel we can run on this machine against libm over random
+//bins, the kernels against each other on the signed zero edge cases, and what peak detection reads off whole
+//frames of steady sinusoids. exits nonzero if anything is past the bounds in SpectrumKernels.h, or those below
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Analysis.h"
+
+#define NUMBINS 20000
+#define BINRANGEDB 90.0 //random bins span this much below full scale
+#define PEAKFREQUENCYBOUND 1.0e-3 //Hz, FAST vs EXACT
+#define PEAKAMPLITUDEBOUND 1.0e-4 //dB, FAST vs EXACT
+#define NUMSINES 64
+
+static int numFailures = 0;
+
+static void check(const char * what, const double error, const double bound){
+    std::cout << "  " << what << ": " << error << " (bound " << bound << ")" << std::endl;
+    if(!(error < bound)){
+        std::cout << "Error: " << what << " out of bounds" << std::endl;
+        numFailures++;
+    }
+}
+
+static const char * isaName(const simd::ISA isa){
+    switch(isa){
+        case simd::ISA::SSE2:
+            return "sse2";
+        case simd::ISA::AVX2:
+            return "avx2";
+        case simd::ISA::NEON:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+static double phaseError(const double a, const double b){//in rad, phases are normalized and wrap at 1
+    double d = fabs(a - b);
+    return 2.0 * M_PI * std::min(d, 1.0 - d);
+}
+
+//////////////////////////////////////////////////////////////
+//  Kernels
+//////////////////////////////////////////////////////////////
+static void checkKernels(const simd::ISA cap, const std::vector<fftwf_complex> &X, std::vector<float> &zeroPhases){
+    const int n = (int)X.size(), numZeros = (int)zeroPhases.size();
+    spectrum::Kernels k = spectrum::select(cap);
+    std::vector<float> amplitudes(n), magnitudes(n), phases(n);
+    double real, imag, amp, phaseMax = 0.0, magnitudeMax = 0.0, amplitudeMax = 0.0;
+    std::cout << isaName(simd::detect(cap)) << std::endl;
+    k.amplitudes(X.data(), amplitudes.data(), 0, n - numZeros, 0.5f);
+    k.magnitudes(X.data(), magnitudes.data(), 0, n - numZeros, 1.0f, 0.0f);
+    k.phases(X.data(), phases.data(), 0, n);
+    for(int i = 0; i < n - numZeros; ++i){
+        real = X[i][0];
+        imag = X[i][1];
+        amp = sqrt(real * real + imag * imag);
+        amplitudeMax = std::max(amplitudeMax, fabs(amplitudes[i] - amp) / amp);
+        magnitudeMax = std::max(magnitudeMax, fabs(magnitudes[i] - 20.0 * log10(amp)));
+        phaseMax = std::max(phaseMax, phaseError(phases[i], (atan2(imag, real) + M_PI) / (2.0 * M_PI)));
+    }
+    check("phase", phaseMax, FASTPHASEERROR);
+    check("magnitude", magnitudeMax, FASTMAGNITUDEERROR);
+    check("amplitude", amplitudeMax, FASTAMPLITUDEERROR);
+    for(int i = 0; i < numZeros; ++i){//libm has its own ideas about atan2(+-0, -0), so these only have to agree with scalar
+        if(cap == simd::ISA::SCALAR){
+            zeroPhases[i] = phases[n - numZeros + i];
+        }
+        else if(phases[n - numZeros + i] != zeroPhases[i]){
+            std::cout << "Error: phase of (" << X[n - numZeros + i][0] << ", " << X[n - numZeros + i][1] << ") is " <<
+            phases[n - numZeros + i] << ", scalar gives " << zeroPhases[i] << std::endl;
+            numFailures++;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////
+//  Peaks
+//////////////////////////////////////////////////////////////
+struct Peak{
+    int bin;
+    double frq, dB, phs;
+};
+
+static Peak findPeak(Analysis &a){
+    float * m;
+    float ml, mr, offset, bias;
+    Peak p;
+    a.update(Analysis::PARAMETER::MAG);
+    m = &a.getMagnitudes();
+    p.bin = 1;
+    for(int i = 2; i < a.getNumBins() - 1; ++i){
+        if(m[i] > m[p.bin]){
+            p.bin = i;
+        }
+    }
+    ml = m[p.bin - 1];
+    mr = m[p.bin + 1];
+    a.getWindowTable().correct(0.5f * (ml - mr) / (ml + mr - 2.0f * m[p.bin]), offset, bias);
+    p.frq = (p.bin + (double)offset) * a.getSamplingRateOverSize();
+    p.dB = m[p.bin] - 0.25f * (ml - mr) * offset + bias + 20.0 * log10(a.getDenormFactor());
+    p.phs = a.getPhase(p.bin);
+    return p;
+}
+
+static void checkPeaks(const windows::TYPE w, const bool padded){
+    const int sr = 44100, ws = 1024;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> frequency(100.0, 16000.0), level(-60.0, 0.0), phase(0.0, 2.0 * M_PI);
+    Analysis exact(w, ws, 4, sr, padded), fast(w, ws, 4, sr, padded);
+    double frqMax = 0.0, dBMax = 0.0, phsMax = 0.0, f, a, p;
+    Peak e, q;
+    fast.setPrecision(Analysis::PRECISION::FAST);
+    std::cout << windows::getName(w) << ((padded)?" padded":" unpadded") << std::endl;
+    for(int s = 0; s < NUMSINES; ++s){
+        f = frequency(rng);
+        a = pow(10.0, level(rng) / 20.0);
+        p = phase(rng);
+        for(int i = 0; i < ws; ++i){
+            exact((float)(a * sin(2.0 * M_PI * f * i / sr + p)));
+            fast((float)(a * sin(2.0 * M_PI * f * i / sr + p)));
+        }
+        exact.transform(Analysis::TRANSFORM::FFT);
+        fast.transform(Analysis::TRANSFORM::FFT);
+        e = findPeak(exact);
+        q = findPeak(fast);
+        if(e.bin != q.bin){
+            std::cout << "Error: " << f << " Hz peaks in bin " << e.bin << " exactly but " << q.bin << " fast" << std::endl;
+            numFailures++;
+            continue;
+        }
+        frqMax = std::max(frqMax, fabs(e.frq - q.frq));
+        dBMax = std::max(dBMax, fabs(e.dB - q.dB));
+        phsMax = std::max(phsMax, phaseError(e.phs, q.phs));
+    }
+    check("peak frequency", frqMax, PEAKFREQUENCYBOUND);
+    check("peak amplitude", dBMax, PEAKAMPLITUDEBOUND);
+    check("peak phase", phsMax, FASTPHASEERROR);
+}
+
+int main(){
+    const simd::ISA caps[] = {simd::ISA::SCALAR, simd::ISA::SSE2, simd::ISA::AVX2};
+    const float zeros[][2] = {{0.0f, 0.0f}, {-0.0f, 0.0f}, {0.0f, -0.0f}, {-0.0f, -0.0f}, {-0.0f, 1.0f}, {-0.0f, -1.0f},
+                              {1.0f, -0.0f}, {-1.0f, 0.0f}, {-1.0f, -0.0f}};
+    const int numZeros = sizeof(zeros) / sizeof(zeros[0]);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> level(-BINRANGEDB, 0.0), phase(-M_PI, M_PI);
+    std::vector<fftwf_complex> X(NUMBINS + numZeros);
+    std::vector<float> zeroPhases(numZeros);
+    double amp, phs;
+    int i;
+    for(i = 0; i < NUMBINS; ++i){
+        amp = pow(10.0, level(rng) / 20.0);
+        phs = phase(rng);
+        X[i][0] = (float)(amp * cos(phs));
+        X[i][1] = (float)(amp * sin(phs));
+    }
+    for(i = 0; i < numZeros; ++i){
+        X[NUMBINS + i][0] = zeros[i][0];
+        X[NUMBINS + i][1] = zeros[i][1];
+    }
+    for(i = 0; i < (int)(sizeof(caps) / sizeof(caps[0])); ++i){
+        if(i == 0 || simd::detect(caps[i]) == caps[i]){//only what this machine can run
+            checkKernels(caps[i], X, zeroPhases);
+        }
+    }
+    if(simd::detect() == simd::ISA::NEON){
+        checkKernels(simd::ISA::NEON, X, zeroPhases);
+    }
+    for(i = 0; i < windows::numTypes; ++i){
+        checkPeaks((windows::TYPE)i, true);
+        checkPeaks((windows::TYPE)i, false);
+    }
+    if(numFailures > 0){
+        std::cout << numFailures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    SynthesisAccuracy.cpp
+    Created: 17 Oct 2026 7:18:31am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+//checks SpectralSynthesis against ideal sinusoids across the whole band, that the oscillator bank picks up
+//where the frames have got to when SynthesisEngine switches back to it, and that a whole model gives steady
+//partials back at the level they went in at. exits nonzero on any failure
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "SinusoidalModel.h"
+
+#define SAMPLERATE 44100
+#define HOPSIZE 256
+#define SETTLEHOPS 8 //grains before the first one that only has the steady partial in it
+#define MEASUREHOPS 64
+#define AMPLITUDEBOUND 2.0e-5 //relative
+#define RESIDUALBOUND -94.0 //dB, what's left after taking out the best fitting sinusoid
+#define SWITCHBOUND 1.05 //peak of the first hop after a switch, relative to where the frames have got to
+#define LEVELBOUND 0.01 //relative, each partial of the model's output
+
+static int numFailures = 0;
+
+static void check(const char * what, const double value, const double bound){
+    if(!(value < bound)){
+        std::cout << "Error: " << what << " " << value << " (bound " << bound << ")" << std::endl;
+        numFailures++;
+    }
+}
+
+//least squares fit of a cos + b sin at f, returns the amplitude and leaves the residual's rms in dB below it
+static double fit(const std::vector<float> &x, const double f, double &residual){
+    double c, s, cc = 0.0, ss = 0.0, cs = 0.0, xc = 0.0, xs = 0.0, det, a, b, e = 0.0, amp;
+    int i;
+    for(i = 0; i < (int)x.size(); ++i){
+        c = cos(2.0 * M_PI * f * i / SAMPLERATE);
+        s = sin(2.0 * M_PI * f * i / SAMPLERATE);
+        cc += c * c;
+        ss += s * s;
+        cs += c * s;
+        xc += x[i] * c;
+        xs += x[i] * s;
+    }
+    det = cc * ss - cs * cs;
+    a = (xc * ss - xs * cs) / det;
+    b = (xs * cc - xc * cs) / det;
+    for(i = 0; i < (int)x.size(); ++i){
+        c = x[i] - a * cos(2.0 * M_PI * f * i / SAMPLERATE) - b * sin(2.0 * M_PI * f * i / SAMPLERATE);
+        e += c * c;
+    }
+    amp = sqrt(a * a + b * b);
+    residual = 10.0 * log10(e / x.size() + 1e-30) - 20.0 * log10(amp / sqrt(2.0));
+    return amp;
+}
+
+static void checkSpectral(){
+    const double frequencies[] = {30.0, 100.0, 440.0, 1000.0, 3150.0, 5000.0, 10000.0, 15000.0, 20000.0, 21900.0};
+    const float amplitude = 0.5f;
+    std::vector<float> out(MEASUREHOPS * HOPSIZE);
+    double amplitudeMax = 0.0, residualMax = -1000.0, residual;
+    for(double f : frequencies){
+        SpectralSynthesis spectral(SAMPLERATE, 4, HOPSIZE);
+        spectral.start(0, amplitude, (float)f, 0.0f);
+        spectral.setGain(0, 1.0f);
+        spectral.setActive(0, true);
+        for(int h = 0; h < SETTLEHOPS; ++h){
+            spectral.render(out.data(), HOPSIZE);
+        }
+        spectral.render(out.data(), (int)out.size());
+        amplitudeMax = std::max(amplitudeMax, fabs(fit(out, f, residual) - amplitude) / amplitude);
+        residualMax = std::max(residualMax, residual);
+    }
+    std::cout << "spectral synthesis, 30 Hz to 21.9 kHz: amplitude " << amplitudeMax << " relative, residual " <<
+    residualMax << " dB" << std::endl;
+    check("spectral synthesis amplitude", amplitudeMax, AMPLITUDEBOUND);
+    check("spectral synthesis residual", residualMax, RESIDUALBOUND);
+}
+
+//a partial fades from 0.5 to 0.1 while the spectral path renders, then the oscillators take over
+static void checkModeSwitch(){
+    Wavetable<float> wavetable(Wavetable<float>::WAVEFORM::SINE, 2048);
+    SynthesisEngine engine(&wavetable, SAMPLERATE, 4, HOPSIZE);
+    Frame frame(4);
+    std::vector<float> out(HOPSIZE);
+    float peak = 0.0f;
+    frame.hopSize = HOPSIZE;
+    frame.activeTracks = 1;
+    frame.denormFactor = 1.0f;
+    engine.setMode(SynthesisEngine::MODE::SPECTRAL);
+    for(int h = 0; h < 16; ++h){
+        frame.numPartials = 0;
+        frame.add(0, (h == 0)?Frame::EVENT::START:Frame::EVENT::UPDATE, TrackStore::STATUS::ALIVE,
+                  (h < 8)?0.5f:0.1f, 440.0f, 0.0f, 1.0f);
+        engine.apply(frame);
+        engine.render(out.data(), HOPSIZE);
+    }
+    engine.setMode(SynthesisEngine::MODE::OSCILLATORS);
+    frame.numPartials = 0;
+    frame.add(0, Frame::EVENT::UPDATE, TrackStore::STATUS::ALIVE, 0.1f, 440.0f, 0.0f, 1.0f);
+    engine.apply(frame);
+    engine.render(out.data(), HOPSIZE);
+    for(float x : out){
+        peak = std::max(peak, fabsf(x));
+    }
+    std::cout << "oscillators after a switch: peak " << peak << " for a partial at 0.1" << std::endl;
+    check("peak after switching back to the oscillators", peak / 0.1f, SWITCHBOUND);
+}
+
+//three steady partials through analysis and resynthesis, with every window and then every resolution count.
+//the second half of a second of output is fitted, by then every track has been alive long enough to be at full gain
+static void checkModelLevel(){
+    const double frequencies[] = {200.0, 1000.0, 5000.0}, amplitudes[] = {0.3, 0.2, 0.1};
+    const int n = SAMPLERATE, block = 512;
+    std::vector<float> x(n), tail;
+    double levelMax = 0.0, residual;
+    int i, k, r, w;
+    for(w = 0; w < windows::numTypes; ++w){
+        for(r = 1; r <= ((w == 0)?MAXRESOLUTIONS:1); ++r){//the long bass window is the slow part, once is enough
+            SinusoidalModel model((windows::TYPE)w, 1024, 4, SAMPLERATE, true, Wavetable<float>::WAVEFORM::SINE, 2048, r);
+            model.init();
+            for(i = 0; i < n; ++i){
+                x[i] = 0.0f;
+                for(k = 0; k < 3; ++k){
+                    x[i] += (float)(amplitudes[k] * sin(2.0 * M_PI * frequencies[k] * i / SAMPLERATE));
+                }
+            }
+            for(i = 0; i < n; i += block){
+                model.process(&x[i], &x[i], std::min(block, n - i));
+            }
+            tail.assign(x.begin() + n / 2, x.end());
+            for(k = 0; k < 3; ++k){
+                levelMax = std::max(levelMax, fabs(fit(tail, frequencies[k], residual) - amplitudes[k]) / amplitudes[k]);
+            }
+        }
+    }
+    std::cout << "model output, every window and resolution count: level " << levelMax << " relative" << std::endl;
+    check("model output level", levelMax, LEVELBOUND);
+}
+
+int main(){
+    checkSpectral();
+    checkModeSwitch();
+    checkModelLevel();
+    if(numFailures > 0){
+        std::cout << numFailures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
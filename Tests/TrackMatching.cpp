@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    TrackMatching.cpp
+    Created: 17 Oct 2026 8:59:03am
+    Author:  Owen Campbell
+
+  ==============================================================================
+*/
+
+//checks findCandidates(), which only looks at the two peaks either side of a track, against the full scan over
+//every peak it replaced. both drive their own TrackStore through the same hops, the way SinusoidalModel's
+//matchPeaks() and birthTracks() do, and every candidate and assignment has to come out the same. frequencies,
+//amplitudes and phases sit on coarse grids, so tracks land exactly between two peaks (frqDiff ties, some of them
+//distSq ties as well), and there are more peaks than tracks, so tracks get stolen. exits nonzero on any failure
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Track.h"
+
+#define NUMTRACKS 24
+#define NUMPARTIALS 16 //wandering partials, plus a few extra peaks around them each hop
+#define NUMHOPS 20000
+#define MAXFREQ 4096
+#define FREQUENCYGRID 2.0f //Hz, every peak's frequency is a multiple of this
+
+static int numFailures = 0;
+
+static void check(const char * what, const double value, const double bound){
+    if(!(value < bound)){
+        std::cout << "Error: " << what << " " << value << " (bound " << bound << ")" << std::endl;
+        numFailures++;
+    }
+}
+
+//the matcher as it was before findCandidates(): every peak within threshold, in ascending order, against every track
+static void scanCandidates(const TrackStore &tracks, const Peak * peaks, const int numPeaks, const float * frequencyThresholds,
+                           TrackMatch * candidates){
+    float lookupAmp, lookupFrq, lookupPhs, frqThreshold;
+    int i, j, k;
+    TrackMatch match;
+    for(i = 0; i < tracks.getNumLive(); ++i){
+        j = tracks.getLive(i);
+        candidates[j].reset();
+        lookupAmp = tracks.getAmp(j);
+        lookupFrq = tracks.getFrq(j);
+        lookupPhs = tracks.getPhs(j);
+        frqThreshold = frequencyThresholds[(int)lookupFrq];
+        for(k = 0; k < numPeaks; ++k){
+            if(fabs(lookupFrq - peaks[k].frq) < frqThreshold){
+                match.init(k, true, peaks[k].amp, peaks[k].frq, peaks[k].phs);
+                match.setDistanceSq(lookupAmp, lookupFrq, lookupPhs);
+                if(matchSort(match, candidates[j])){
+                    candidates[j] = match;
+                }
+            }
+        }
+    }
+}
+
+//one model's worth of matching state
+struct Matcher{
+    Arena * arena;
+    TrackStore tracks;
+    std::vector<TrackMatch> candidates;
+    std::vector<Peak> peaks;
+    std::vector<int> assigned;//peak each track took this hop, -1 for none
+    std::vector<bool> matches;
+    int numStolen;
+    Matcher(){
+        Arena measure;
+        tracks.carve(measure, NUMTRACKS);
+        arena = new Arena(measure.getUsed());
+        tracks.carve(*arena, NUMTRACKS);
+        tracks.setLifetimes(0, 3);
+        candidates.resize(NUMTRACKS);
+        assigned.resize(NUMTRACKS);
+        matches.resize(NUMTRACKS);
+        numStolen = 0;
+    }
+    ~Matcher(){
+        delete arena;
+    }
+    //matchPeaks(), birthTracks() and the track half of updateTracks()
+    void hop(const std::vector<Peak> &p, const float * frequencyThresholds, const bool scan, const int hopIndex){
+        int i, j, k;
+        peaks = p;
+        std::fill(assigned.begin(), assigned.end(), -1);
+        std::fill(matches.begin(), matches.end(), false);
+        if(scan){
+            scanCandidates(tracks, peaks.data(), (int)peaks.size(), frequencyThresholds, candidates.data());
+        }
+        else{
+            findCandidates(tracks, peaks.data(), (int)peaks.size(), frequencyThresholds, candidates.data());
+        }
+        for(i = 0; i < tracks.getNumLive(); ++i){
+            j = tracks.getLive(i);
+            k = candidates[j].idx;
+            if(k >= 0 && !peaks[k].assigned){
+                tracks.update(j, true, peaks[k].amp, peaks[k].frq, peaks[k].phs);
+                peaks[k].assigned = true;
+                matches[j] = true;
+                assigned[j] = k;
+            }
+        }
+        for(k = 0; k < (int)peaks.size(); ++k){
+            if(!peaks[k].assigned){
+                if((j = tracks.birth()) < 0){//the model steals at random, the same track for both will do here
+                    j = (hopIndex * 7 + k * 3) % (NUMTRACKS - 1);
+                    tracks.restart(j);
+                    numStolen++;
+                }
+                matches[j] = true;
+                tracks.update(j, true, peaks[k].amp, peaks[k].frq, peaks[k].phs);
+                assigned[j] = k;
+            }
+        }
+        tracks.admit();
+        for(i = 0; i < tracks.getNumLive(); ++i){
+            j = tracks.getLive(i);
+            if(tracks.isActive(j) && !matches[j]){
+                tracks.update(j, false);
+            }
+        }
+        tracks.retire();
+    }
+};
+
+//a track whose two neighbouring peaks are both in range and the same distance away in frequency
+static bool isTied(const TrackStore &tracks, const int j, const std::vector<Peak> &peaks, const float * frequencyThresholds){
+    float f = tracks.getFrq(j), threshold = frequencyThresholds[(int)f];
+    int k = (int)(std::lower_bound(peaks.begin(), peaks.end(), f, Peak::below) - peaks.begin());
+    return k > 0 && k < (int)peaks.size() && f - peaks[k - 1].frq == peaks[k].frq - f && f - peaks[k - 1].frq < threshold;
+}
+
+int main(){
+    const float amplitudes[] = {0.1f, 0.2f, 0.3f}, phases[] = {0.0f, 0.25f, 0.5f};
+    std::vector<float> frequencyThresholds(MAXFREQ), partials(NUMPARTIALS);
+    std::vector<Peak> peaks;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> step(-1, 1), grid(16, MAXFREQ / (int)FREQUENCYGRID - 16), pick(0, 2),
+                                       extras(0, 12), offset(-3, 3), partial(0, NUMPARTIALS - 1);
+    Matcher scan, search;
+    long numCandidates = 0, numAssigned = 0, numTies = 0, candidateErrors = 0, assignmentErrors = 0;
+    int h, i, j, k, n;
+    float f;
+    for(i = 0; i < MAXFREQ; ++i){
+        frequencyThresholds[i] = 5.0f + i * 0.002f;
+    }
+    for(k = 0; k < NUMPARTIALS; ++k){
+        partials[k] = grid(rng) * FREQUENCYGRID;
+    }
+    for(h = 0; h < NUMHOPS; ++h){
+        peaks.clear();
+        n = (h % 97 == 0)?0:NUMPARTIALS + extras(rng);//now and then a hop with nothing in it
+        for(k = 0; k < n; ++k){
+            if(k < NUMPARTIALS){
+                partials[k] = std::min(std::max(partials[k] + step(rng) * FREQUENCYGRID, 32.0f), MAXFREQ - 32.0f);
+                f = partials[k];
+            }
+            else{//near one of them, so tracks see a peak either side
+                f = partials[partial(rng)] + offset(rng) * FREQUENCYGRID;
+            }
+            peaks.push_back(Peak());
+            peaks.back().init(0, amplitudes[pick(rng)], f, phases[pick(rng)]);
+        }
+        //detection leaves one peak per frequency, in ascending order
+        std::stable_sort(peaks.begin(), peaks.end(), [](const Peak &a, const Peak &b){return a.frq < b.frq;});
+        peaks.erase(std::unique(peaks.begin(), peaks.end(), [](const Peak &a, const Peak &b){return a.frq == b.frq;}), peaks.end());
+        for(k = 0; k < (int)peaks.size(); ++k){
+            peaks[k].bin = k;
+        }
+        for(i = 0; i < scan.tracks.getNumLive(); ++i){
+            numTies += isTied(scan.tracks, scan.tracks.getLive(i), peaks, frequencyThresholds.data());
+        }
+        scan.hop(peaks, frequencyThresholds.data(), true, h);
+        search.hop(peaks, frequencyThresholds.data(), false, h);
+        for(j = 0; j < NUMTRACKS; ++j){
+            numCandidates += scan.candidates[j].idx >= 0;
+            numAssigned += scan.assigned[j] >= 0;
+            candidateErrors += scan.candidates[j].idx != search.candidates[j].idx;
+            assignmentErrors += scan.assigned[j] != search.assigned[j];
+        }
+        if(candidateErrors + assignmentErrors > 0){//the two stores have gone their own ways, nothing after this compares
+            std::cout << "Error: matchers first differ at hop " << h << std::endl;
+            break;
+        }
+    }
+    std::cout << "matching over " << h << " hops: " << numCandidates << " candidates, " << numAssigned << " assignments, "
+              << numTies << " frequency ties, " << search.numStolen << " steals" << std::endl;
+    check("candidates differing from the full scan", candidateErrors, 1);
+    check("assignments differing from the full scan", assignmentErrors, 1);
+    check("steals differing from the full scan", std::abs(scan.numStolen - search.numStolen), 1);
+    if(numTies == 0 || search.numStolen == 0){//the awkward cases have to have come up for any of that to mean much
+        std::cout << "Error: no frequency ties or no steals" << std::endl;
+        numFailures++;
+    }
+    if(numFailures > 0){
+        std::cout << numFailures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}